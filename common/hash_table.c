@@ -0,0 +1,156 @@
+#include "hash_table.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct hash_table_entry {
+	uint64_t hash;
+	void *value;
+	size_t key_len;
+	struct hash_table_entry *next;
+	char key[];
+};
+
+// FNV-1a
+static uint64_t hash_key(const void *key, size_t key_len) {
+	const unsigned char *bytes = key;
+	uint64_t hash = 14695981039346656037ULL;
+	for (size_t i = 0; i < key_len; ++i) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+hash_table_t *create_hash_table(void) {
+	hash_table_t *table = malloc(sizeof(hash_table_t));
+	if (!table) {
+		return NULL;
+	}
+	table->capacity = 16;
+	table->length = 0;
+	table->buckets = calloc(table->capacity, sizeof(struct hash_table_entry *));
+	if (!table->buckets) {
+		free(table);
+		return NULL;
+	}
+	return table;
+}
+
+void hash_table_free(hash_table_t *table) {
+	if (table == NULL) {
+		return;
+	}
+	for (size_t i = 0; i < table->capacity; ++i) {
+		struct hash_table_entry *entry = table->buckets[i];
+		while (entry) {
+			struct hash_table_entry *next = entry->next;
+			free(entry);
+			entry = next;
+		}
+	}
+	free(table->buckets);
+	free(table);
+}
+
+static struct hash_table_entry **find_entry(hash_table_t *table,
+		const void *key, size_t key_len, uint64_t hash) {
+	struct hash_table_entry **entry =
+		&table->buckets[hash & (table->capacity - 1)];
+	while (*entry) {
+		if ((*entry)->hash == hash && (*entry)->key_len == key_len &&
+				memcmp((*entry)->key, key, key_len) == 0) {
+			break;
+		}
+		entry = &(*entry)->next;
+	}
+	return entry;
+}
+
+void *hash_table_get(hash_table_t *table, const void *key, size_t key_len) {
+	struct hash_table_entry *entry =
+		*find_entry(table, key, key_len, hash_key(key, key_len));
+	return entry ? entry->value : NULL;
+}
+
+static void hash_table_grow(hash_table_t *table) {
+	size_t capacity = table->capacity * 2;
+	struct hash_table_entry **buckets =
+		calloc(capacity, sizeof(struct hash_table_entry *));
+	if (!buckets) {
+		// Keep using the current buckets, lookups just get slower
+		return;
+	}
+	for (size_t i = 0; i < table->capacity; ++i) {
+		struct hash_table_entry *entry = table->buckets[i];
+		while (entry) {
+			struct hash_table_entry *next = entry->next;
+			struct hash_table_entry **bucket =
+				&buckets[entry->hash & (capacity - 1)];
+			entry->next = *bucket;
+			*bucket = entry;
+			entry = next;
+		}
+	}
+	free(table->buckets);
+	table->buckets = buckets;
+	table->capacity = capacity;
+}
+
+bool hash_table_set(hash_table_t *table, const void *key, size_t key_len,
+		void *value) {
+	uint64_t hash = hash_key(key, key_len);
+	struct hash_table_entry **entry = find_entry(table, key, key_len, hash);
+	if (*entry) {
+		(*entry)->value = value;
+		return true;
+	}
+	struct hash_table_entry *new_entry =
+		malloc(sizeof(struct hash_table_entry) + key_len);
+	if (!new_entry) {
+		return false;
+	}
+	new_entry->hash = hash;
+	new_entry->value = value;
+	new_entry->key_len = key_len;
+	new_entry->next = NULL;
+	memcpy(new_entry->key, key, key_len);
+	*entry = new_entry;
+
+	if (++table->length > table->capacity * 3 / 4) {
+		hash_table_grow(table);
+	}
+	return true;
+}
+
+void *hash_table_remove(hash_table_t *table, const void *key, size_t key_len) {
+	struct hash_table_entry **entry =
+		find_entry(table, key, key_len, hash_key(key, key_len));
+	struct hash_table_entry *removed = *entry;
+	if (!removed) {
+		return NULL;
+	}
+	void *value = removed->value;
+	*entry = removed->next;
+	free(removed);
+	table->length--;
+	return value;
+}
+
+void hash_table_foreach(hash_table_t *table,
+		void (*callback)(const void *key, size_t key_len, void *value,
+			void *data),
+		void *data) {
+	if (table == NULL || callback == NULL) {
+		return;
+	}
+	for (size_t i = 0; i < table->capacity; ++i) {
+		struct hash_table_entry *entry = table->buckets[i];
+		while (entry) {
+			// Allow the callback to remove the current entry
+			struct hash_table_entry *next = entry->next;
+			callback(entry->key, entry->key_len, entry->value, data);
+			entry = next;
+		}
+	}
+}
@@ -0,0 +1,31 @@
+#ifndef _SWAY_HASH_TABLE_H
+#define _SWAY_HASH_TABLE_H
+#include <stdbool.h>
+#include <stddef.h>
+
+struct hash_table_entry;
+
+/**
+ * A hash table with arbitrary byte string keys. Keys are copied into the
+ * table, values are not owned by it.
+ */
+typedef struct {
+	size_t capacity; // Number of buckets, always a power of two
+	size_t length;
+	struct hash_table_entry **buckets;
+} hash_table_t;
+
+hash_table_t *create_hash_table(void);
+void hash_table_free(hash_table_t *table);
+// Returns NULL if the key isn't in the table.
+void *hash_table_get(hash_table_t *table, const void *key, size_t key_len);
+// Replaces any existing value for the key. Returns false on allocation failure.
+bool hash_table_set(hash_table_t *table, const void *key, size_t key_len,
+		void *value);
+// Returns the removed value, or NULL if the key wasn't in the table.
+void *hash_table_remove(hash_table_t *table, const void *key, size_t key_len);
+void hash_table_foreach(hash_table_t *table,
+		void (*callback)(const void *key, size_t key_len, void *value,
+			void *data),
+		void *data);
+#endif
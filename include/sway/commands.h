@@ -52,6 +52,29 @@ struct cmd_handler *find_handler(char *line, struct cmd_handler *cmd_handlers,
  * Parse and executes a command.
  */
 struct cmd_results *execute_command(char *command,  struct sway_seat *seat);
+/**
+ * A command string parsed once into handlers, arguments and criteria, so it
+ * can be executed repeatedly without being parsed again.
+ */
+struct compiled_command;
+/**
+ * Parses a command string for execute_compiled_command. Returns NULL if the
+ * command is invalid, in which case it should be run with execute_command to
+ * report the error.
+ */
+struct compiled_command *compile_command(const char *command);
+/**
+ * Executes a compiled command. Equivalent to execute_command on the string it
+ * was compiled from.
+ */
+struct cmd_results *execute_compiled_command(
+		struct compiled_command *compiled, struct sway_seat *seat);
+void free_compiled_command(struct compiled_command *compiled);
+/**
+ * Returns true if any command of a compiled command runs the given handler.
+ */
+bool compiled_command_has_handler(struct compiled_command *compiled,
+		sway_cmd *handle);
 /**
  * Parse and handles a command during config file loading.
  *
@@ -242,6 +265,8 @@ sway_cmd output_cmd_transform;
 sway_cmd seat_cmd_attach;
 sway_cmd seat_cmd_fallback;
 sway_cmd seat_cmd_cursor;
+sway_cmd seat_cmd_motion_coalescing;
+sway_cmd seat_cmd_pointer_constraint;
 
 sway_cmd cmd_ipc_cmd;
 sway_cmd cmd_ipc_events;
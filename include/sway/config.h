@@ -6,6 +6,7 @@
 #include <time.h>
 #include <wlr/types/wlr_box.h>
 #include <xkbcommon/xkbcommon.h>
+#include "hash_table.h"
 #include "list.h"
 #include "swaynag.h"
 #include "tree/container.h"
@@ -22,6 +23,17 @@ struct sway_variable {
 	char *value;
 };
 
+/**
+ * A trie over variable names, used to find the longest variable name at a
+ * position in a single pass. Children are kept in a sibling list.
+ */
+struct sway_variable_trie {
+	char c;
+	struct sway_variable *var; // variable whose name ends here, or NULL
+	struct sway_variable_trie *child;
+	struct sway_variable_trie *next;
+};
+
 
 enum binding_input_type {
 	BINDING_KEYCODE,
@@ -47,6 +59,8 @@ struct sway_binding {
 	list_t *keys; // sorted in ascending order
 	uint32_t modifiers;
 	char *command;
+	struct compiled_command *compiled; // parsed on first use
+	bool uncompilable; // run with execute_command instead
 };
 
 /**
@@ -65,6 +79,9 @@ struct sway_mode {
 	list_t *keysym_bindings;
 	list_t *keycode_bindings;
 	list_t *mouse_bindings;
+	// Keyboard bindings by modifiers, release flag and sorted keys
+	hash_table_t *keysym_index;
+	hash_table_t *keycode_index;
 	bool pango;
 };
 
@@ -123,10 +140,26 @@ struct seat_attachment_config {
 /**
  * Options for multiseat and other misc device configurations
  */
+enum seat_config_motion_coalescing {
+	MOTION_COALESCING_DEFAULT, // not set
+	MOTION_COALESCING_DISABLE,
+	MOTION_COALESCING_FRAME, // process motion once per output frame
+	MOTION_COALESCING_RATE, // process motion at most motion_rate times a second
+};
+
+enum seat_config_pointer_constraint {
+	POINTER_CONSTRAINT_DEFAULT, // not set
+	POINTER_CONSTRAINT_ENABLE,
+	POINTER_CONSTRAINT_DISABLE,
+};
+
 struct seat_config {
 	char *name;
 	int fallback; // -1 means not set
 	list_t *attachments; // list of seat_attachment configs
+	enum seat_config_motion_coalescing motion_coalescing;
+	int motion_rate;
+	enum seat_config_pointer_constraint pointer_constraint;
 };
 
 enum config_dpms {
@@ -300,6 +333,20 @@ struct ipc_policy {
 	uint32_t features;
 };
 
+struct config_profile_entry {
+	char *name;
+	int count;
+	uint64_t nsec;
+};
+
+/**
+ * Parse times collected by `sway --validate --profile`.
+ */
+struct config_profile {
+	hash_table_t *commands; // struct config_profile_entry * by command name
+	list_t *files; // struct config_profile_entry *, in load order
+};
+
 enum focus_wrapping_mode {
 	WRAP_NO,
 	WRAP_YES,
@@ -313,6 +360,7 @@ struct sway_config {
 	char *swaynag_command;
 	struct swaynag_instance swaynag_config_errors;
 	list_t *symbols;
+	struct sway_variable_trie *symbols_trie;
 	list_t *modes;
 	list_t *bars;
 	list_t *cmd_queue;
@@ -321,6 +369,7 @@ struct sway_config {
 	list_t *input_configs;
 	list_t *seat_configs;
 	list_t *criteria;
+	struct criteria_index *criteria_index;
 	list_t *no_focus;
 	list_t *active_bar_modifiers;
 	struct sway_mode *current_mode;
@@ -350,6 +399,7 @@ struct sway_config {
 	bool reloading;
 	bool reading;
 	bool validating;
+	struct config_profile *profile; // NULL unless profiling
 	bool auto_back_and_forth;
 	bool show_marks;
 
@@ -406,9 +456,11 @@ struct sway_config {
 
 /**
  * Loads the main config from the given path. is_active should be true when
- * reloading the config.
+ * reloading the config. If profiling is true, parse times are collected in
+ * config->profile.
  */
-bool load_main_config(const char *path, bool is_active, bool validating);
+bool load_main_config(const char *path, bool is_active, bool validating,
+		bool profiling);
 
 /**
  * Loads an included config. Can only be used after load_main_config.
@@ -422,6 +474,11 @@ bool load_include_configs(const char *path, struct sway_config *config,
 bool read_config(FILE *file, struct sway_config *config,
 		struct swaynag_instance *swaynag);
 
+/**
+ * Prints the parse times collected in config->profile to stdout.
+ */
+void print_config_profile(struct sway_config *config);
+
 /**
  * Free config struct
  */
@@ -429,6 +486,14 @@ void free_config(struct sway_config *config);
 
 void free_sway_variable(struct sway_variable *var);
 
+/**
+ * Adds a variable to the config's variable trie.
+ */
+bool variable_trie_add(struct sway_variable_trie *trie,
+		struct sway_variable *var);
+
+void variable_trie_free(struct sway_variable_trie *trie);
+
 /**
  * Does variable replacement for a string based on the config's currently loaded variables.
  */
@@ -446,6 +511,8 @@ struct input_config *copy_input_config(struct input_config *ic);
 
 void free_input_config(struct input_config *ic);
 
+bool input_config_equal(struct input_config *a, struct input_config *b);
+
 void apply_input_config(struct input_config *input);
 
 int seat_name_cmp(const void *item, const void *data);
@@ -458,6 +525,8 @@ struct seat_config *copy_seat_config(struct seat_config *seat);
 
 void free_seat_config(struct seat_config *ic);
 
+bool seat_config_equal(struct seat_config *a, struct seat_config *b);
+
 struct seat_attachment_config *seat_attachment_config_new();
 
 struct seat_attachment_config *seat_config_get_attachment(
@@ -483,6 +552,8 @@ void apply_output_config_to_outputs(struct output_config *oc);
 
 void free_output_config(struct output_config *oc);
 
+bool output_config_equal(struct output_config *a, struct output_config *b);
+
 void create_default_output_configs(void);
 
 int workspace_output_cmp_workspace(const void *a, const void *b);
@@ -495,10 +566,43 @@ int sway_binding_cmp_keys(const void *a, const void *b);
 
 void free_sway_binding(struct sway_binding *sb);
 
+/**
+ * Find the keysym or keycode binding of a mode which is triggered by exactly
+ * the given modifiers and sorted set of pressed keys. The locked flag isn't
+ * part of the lookup and must be checked by the caller.
+ */
+struct sway_binding *mode_find_binding(struct sway_mode *mode,
+		enum binding_input_type type, uint32_t modifiers, bool release,
+		const uint32_t *keys, size_t keys_len);
+
 void seat_execute_command(struct sway_seat *seat, struct sway_binding *binding);
 
+/**
+ * Execute the command of a binding from an idle callback, together with any
+ * other deferred bindings, so that input handling doesn't wait for it.
+ * Commands which change how the following input is handled, such as mode, run
+ * immediately after the already deferred ones.
+ */
+void seat_execute_command_deferred(struct sway_seat *seat,
+		struct sway_binding *binding);
+
+/**
+ * Execute deferred binding commands now, in the order they were deferred.
+ */
+void execute_deferred_commands(void);
+
+void seat_cancel_deferred_commands(struct sway_seat *seat);
+
 void load_swaybars();
 
+/**
+ * Starts swaybar for each bar which isn't already running, such as those
+ * whose config changed in a reload.
+ */
+void load_new_swaybars(void);
+
+bool bar_config_equal(struct bar_config *a, struct bar_config *b);
+
 void invoke_swaybar(struct bar_config *bar);
 
 void terminate_swaybg(pid_t pid);
@@ -3,6 +3,7 @@
 
 #include <pcre.h>
 #include "config.h"
+#include "hash_table.h"
 #include "list.h"
 #include "tree/view.h"
 
@@ -14,23 +15,46 @@ enum criteria_type {
 	CT_NO_FOCUS                = 1 << 4,
 };
 
+enum pattern_type {
+	PATTERN_PCRE,     // Matched with pcre_exec, JIT compiled if possible
+	PATTERN_CONTAINS, // A plain literal, which matches anywhere in the string
+	PATTERN_PREFIX,   // A literal anchored with ^
+	PATTERN_EXACT,    // A literal anchored with both ^ and $
+};
+
+/**
+ * A criteria value. Values which are plain or anchored literals are detected
+ * when the criteria is parsed and matched without PCRE.
+ */
+struct pattern {
+	enum pattern_type match_type;
+	char *literal;
+	size_t literal_len;
+	pcre *regex;
+	pcre_extra *regex_extra;
+};
+
 struct criteria {
 	enum criteria_type type;
+	int index; // Position in config->criteria
+	uint32_t depends; // enum sway_view_prop_mask
 	char *raw; // entire criteria string (for logging)
 	char *cmdlist;
+	struct compiled_command *compiled_cmdlist; // parsed on first use
+	bool uncompilable; // run with execute_command instead
 	char *target; // workspace or output name for `assign` criteria
 
-	pcre *title;
-	pcre *shell;
-	pcre *app_id;
-	pcre *class;
-	pcre *instance;
-	pcre *con_mark;
+	struct pattern *title;
+	struct pattern *shell;
+	struct pattern *app_id;
+	struct pattern *class;
+	struct pattern *instance;
+	struct pattern *con_mark;
 	uint32_t con_id; // internal ID
 #ifdef HAVE_XWAYLAND
 	uint32_t id; // X11 window ID
 #endif
-	pcre *window_role;
+	struct pattern *window_role;
 	uint32_t window_type;
 	bool floating;
 	bool tiling;
@@ -38,6 +62,24 @@ struct criteria {
 	char *workspace;
 };
 
+/**
+ * An index over config->criteria. Criteria with an exact app_id, class,
+ * instance or shell value are stored in a hash table under that value, so
+ * only criteria which could possibly match need to be checked for a view.
+ * The rest are kept in the residual list.
+ */
+struct criteria_index {
+	hash_table_t *by_app_id; // list_t of struct criteria *
+	hash_table_t *by_class;
+	hash_table_t *by_instance;
+	hash_table_t *by_shell;
+	list_t *residual;
+};
+
+struct criteria_index *criteria_index_create(void);
+
+void criteria_index_destroy(struct criteria_index *index);
+
 bool criteria_is_empty(struct criteria *criteria);
 
 void criteria_destroy(struct criteria *criteria);
@@ -52,6 +94,11 @@ void criteria_destroy(struct criteria *criteria);
  */
 struct criteria *criteria_parse(char *raw, char **error);
 
+/**
+ * Add the criteria to the config's criteria list and index.
+ */
+void criteria_add(struct criteria *criteria);
+
 /**
  * Compile a list of criterias matching the given view.
  *
@@ -59,6 +106,13 @@ struct criteria *criteria_parse(char *raw, char **error);
  */
 list_t *criteria_for_view(struct sway_view *view, enum criteria_type types);
 
+/**
+ * Like criteria_for_view, but only criteria depending on one of the changed
+ * properties (see enum sway_view_prop_mask) are tested.
+ */
+list_t *criteria_for_view_changed(struct sway_view *view,
+		enum criteria_type types, uint32_t changed);
+
 /**
  * Compile a list of views matching the given criteria.
  */
@@ -7,6 +7,8 @@ struct sway_debug {
 	bool render_tree;      // Render the tree overlay
 	bool txn_timings;      // Log verbose messages about transactions
 	bool txn_wait;         // Always wait for the timeout before applying
+	bool input_latency;    // Trace the latency of input events
+	const char *input_trace; // Path of the binary input latency trace
 
 	enum {
 		DAMAGE_DEFAULT,    // Default behaviour
@@ -1,3 +1,4 @@
+#include <wlr/types/wlr_box.h>
 #include <wlr/types/wlr_surface.h>
 
 struct sway_container;
@@ -11,3 +12,11 @@ void desktop_damage_whole_container(struct sway_container *con);
 void desktop_damage_box(struct wlr_box *box);
 
 void desktop_damage_view(struct sway_view *view);
+
+#define RESIZE_OUTLINE_EDGES 4
+
+// The edges of the outline of a container's pending size while it's resized
+void desktop_get_resize_outline(struct sway_container *con,
+	struct wlr_box edges[static RESIZE_OUTLINE_EDGES]);
+
+void desktop_damage_resize_outline(struct sway_container *con);
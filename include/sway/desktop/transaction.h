@@ -28,6 +28,13 @@ struct sway_transaction_instruction;
  */
 void transaction_commit_dirty(void);
 
+/**
+ * Like transaction_commit_dirty, but if a transaction is still waiting for
+ * views the dirty containers are left until it's done. This is used during
+ * interactive operations so views are only configured as fast as they respond.
+ */
+void transaction_commit_dirty_throttled(void);
+
 /**
  * Notify the transaction system that a view is ready for the new layout.
  *
@@ -1,9 +1,31 @@
 #ifndef _SWAY_INPUT_CURSOR_H
 #define _SWAY_INPUT_CURSOR_H
+#include <pixman.h>
 #include <stdint.h>
+#include <time.h>
+#include <wlr/types/wlr_pointer_constraints_v1.h>
 #include "sway/input/seat.h"
 
 #define SWAY_CURSOR_PRESSED_BUTTONS_CAP 32
+#define SWAY_CURSOR_TOUCH_POINTS_CAP 16
+
+/**
+ * The result of the last hit test of an input point, which lets the next one
+ * skip walking the tree. It's only valid while the root generation is
+ * unchanged.
+ */
+struct sway_hit {
+	bool valid;
+	uint64_t generation;
+	struct sway_container *container;
+	bool unobscured; // a focused tiling view nothing can be drawn over
+};
+
+struct sway_touch_point {
+	bool active;
+	int32_t touch_id;
+	struct sway_hit hit;
+};
 
 struct sway_cursor {
 	struct sway_seat *seat;
@@ -16,6 +38,20 @@ struct sway_cursor {
 	const char *image;
 	struct wl_client *image_client;
 
+	// Result of the hit test done by the last pointer motion, at the previous
+	// position
+	struct sway_hit hit;
+	struct sway_touch_point touch_points[SWAY_CURSOR_TOUCH_POINTS_CAP];
+
+	// Pointer motion which hasn't been processed yet because of the seat's
+	// motion_coalescing setting
+	bool motion_pending;
+	uint32_t motion_time_msec;
+	struct timespec motion_processed; // when motion was last processed
+	struct wl_event_source *motion_timer;
+	// Layout coordinates of the origin of the surface with pointer focus
+	double focus_ox, focus_oy;
+
 	struct wl_listener motion;
 	struct wl_listener motion_absolute;
 	struct wl_listener button;
@@ -32,6 +68,12 @@ struct sway_cursor {
 
 	struct wl_listener request_set_cursor;
 
+	// While a pointer constraint is active, relative motion goes straight to
+	// the constrained surface, confined to the region (empty when locked)
+	struct wlr_pointer_constraint_v1 *active_constraint;
+	pixman_region32_t confine;
+	struct wl_listener constraint_commit;
+
 	// Mouse binding state
 	uint32_t pressed_buttons[SWAY_CURSOR_PRESSED_BUTTONS_CAP];
 	size_t pressed_button_count;
@@ -41,10 +83,37 @@ void sway_cursor_destroy(struct sway_cursor *cursor);
 struct sway_cursor *sway_cursor_create(struct sway_seat *seat);
 void cursor_send_pointer_motion(struct sway_cursor *cursor, uint32_t time_msec,
 	bool allow_refocusing);
+/**
+ * Process pointer motion which was held back by motion coalescing, if any.
+ */
+void cursor_flush_motion(struct sway_cursor *cursor);
+/**
+ * Activate a pointer constraint of the surface the seat focused, or deactivate
+ * the active one if constraint is NULL.
+ */
+void cursor_constrain(struct sway_cursor *cursor,
+		struct wlr_pointer_constraint_v1 *constraint);
 void dispatch_cursor_button(struct sway_cursor *cursor, uint32_t time_msec,
 	uint32_t button, enum wlr_button_state state);
 
+/**
+ * Find the container and surface at a point in layout coordinates, including
+ * layer and unmanaged surfaces. The hit of the input point being tested, if
+ * any, is used to skip the tree walk when possible and updated afterwards.
+ */
+struct sway_container *cursor_hit_test(struct sway_cursor *cursor,
+		struct sway_hit *hit, double lx, double ly,
+		struct wlr_surface **surface, double *sx, double *sy);
+
 void cursor_set_image(struct sway_cursor *cursor, const char *image,
 		struct wl_client *client);
 
+/**
+ * Get a reference to the xcursor manager of a theme and size, which is shared
+ * between seats. Themes are loaded for each scale by wlr_xcursor_manager_load.
+ */
+struct wlr_xcursor_manager *xcursor_manager_get(const char *theme,
+		unsigned size);
+void xcursor_manager_put(struct wlr_xcursor_manager *manager);
+
 #endif
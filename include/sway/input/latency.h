@@ -0,0 +1,93 @@
+#ifndef _SWAY_INPUT_LATENCY_H
+#define _SWAY_INPUT_LATENCY_H
+#include <stdint.h>
+#include <time.h>
+
+struct sway_output;
+
+/**
+ * Input latency tracing, enabled with -Dinput-latency or -Dinput-trace=<path>.
+ *
+ * An input event is followed from its device timestamp to the frame which
+ * shows its effect, in three stages:
+ *
+ * - input: from the device timestamp until sway dispatches the event
+ * - dispatch: from the dispatch until a frame containing damage caused after
+ *   it is committed
+ * - commit: from the commit until the output is ready for the next frame,
+ *   which is when the committed frame has been presented
+ *
+ * Only the oldest event of each type is followed at a time, and the first
+ * damage to any output after it is dispatched is attributed to it.
+ */
+
+enum latency_event_type {
+	LATENCY_KEY,
+	LATENCY_BUTTON,
+	LATENCY_MOTION,
+	LATENCY_AXIS,
+	LATENCY_TOUCH,
+	LATENCY_TABLET,
+	LATENCY_EVENT_TYPE_COUNT,
+};
+
+enum latency_stage {
+	LATENCY_STAGE_INPUT,
+	LATENCY_STAGE_DISPATCH,
+	LATENCY_STAGE_COMMIT,
+	LATENCY_STAGE_COUNT,
+};
+
+// Bucket i counts latencies below 2^i microseconds, the last one the rest
+#define LATENCY_HISTOGRAM_BUCKETS 24
+
+struct latency_stats {
+	uint64_t count;
+	uint64_t sum_us;
+	uint64_t max_us;
+	uint64_t histogram[LATENCY_HISTOGRAM_BUCKETS];
+};
+
+/**
+ * A record of the trace file, which starts with the 8 bytes "SWAYLAT1".
+ * Records are written in host byte order when the event is presented.
+ * Timestamps are CLOCK_MONOTONIC.
+ */
+struct latency_trace_record {
+	uint32_t type; // enum latency_event_type
+	uint32_t input_msec; // device timestamp of the event
+	uint64_t dispatch_nsec;
+	uint64_t commit_nsec;
+	uint64_t present_nsec;
+};
+
+void latency_init(void);
+
+void latency_finish(void);
+
+void latency_input_dispatched(enum latency_event_type type,
+		uint32_t time_msec);
+
+/**
+ * Called when damage is added to an output.
+ */
+void latency_damage(struct sway_output *output);
+
+/**
+ * Called when a frame has been committed to an output.
+ */
+void latency_output_commit(struct sway_output *output);
+
+/**
+ * Called when an output is ready for a new frame.
+ */
+void latency_output_present(struct sway_output *output);
+
+const char *latency_event_type_name(enum latency_event_type type);
+
+const char *latency_stage_name(enum latency_stage stage);
+
+const struct latency_stats *latency_get_stats(enum latency_event_type type,
+		enum latency_stage stage);
+
+#endif
@@ -22,6 +22,13 @@ struct sway_output {
 	struct timespec last_frame;
 	struct wlr_output_damage *damage;
 
+	// Reported in GET_OUTPUTS, to check that cursor motion on a hardware
+	// cursor plane doesn't lead to composition
+	struct {
+		uint64_t frames;     // Frame events handled
+		uint64_t composited; // Frames which had damage and were rendered
+	} frame_stats;
+
 	struct wl_listener destroy;
 	struct wl_listener mode;
 	struct wl_listener transform;
@@ -8,6 +8,8 @@
 #include <wlr/types/wlr_compositor.h>
 #include <wlr/types/wlr_data_device.h>
 #include <wlr/types/wlr_layer_shell.h>
+#include <wlr/types/wlr_pointer_constraints_v1.h>
+#include <wlr/types/wlr_relative_pointer_v1.h>
 #include <wlr/types/wlr_server_decoration.h>
 #include <wlr/types/wlr_xdg_shell_v6.h>
 #include <wlr/types/wlr_xdg_shell.h>
@@ -50,6 +52,11 @@ struct sway_server {
 	struct wl_listener xwayland_ready;
 #endif
 
+	struct wlr_relative_pointer_manager_v1 *relative_pointer_manager;
+
+	struct wlr_pointer_constraints_v1 *pointer_constraints;
+	struct wl_listener pointer_constraint;
+
 	struct wlr_server_decoration_manager *server_decoration_manager;
 	struct wl_listener server_decoration;
 	struct wl_list decorations; // sway_server_decoration::link
@@ -78,5 +85,6 @@ void handle_xdg_shell_surface(struct wl_listener *listener, void *data);
 void handle_xwayland_surface(struct wl_listener *listener, void *data);
 #endif
 void handle_server_decoration(struct wl_listener *listener, void *data);
+void handle_pointer_constraint(struct wl_listener *listener, void *data);
 
 #endif
@@ -75,6 +75,11 @@ struct sway_container_state {
 	struct sway_container *focused_inactive_child;
 	bool focused;
 
+	// Calculated when the transaction is applied. True if the container isn't
+	// hidden within its workspace by an inactive tab or stack or by a
+	// fullscreen container.
+	bool visible;
+
 	// View properties
 	double view_x, view_y;
 	double view_width, view_height;
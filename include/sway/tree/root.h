@@ -6,6 +6,7 @@
 #include <wlr/render/wlr_texture.h>
 #include "sway/tree/container.h"
 #include "config.h"
+#include "hash_table.h"
 #include "list.h"
 
 extern struct sway_container root_container;
@@ -27,6 +28,13 @@ struct sway_root {
 	list_t *scratchpad; // struct sway_container
 	list_t *saved_workspaces; // For when there's no connected outputs
 
+	hash_table_t *containers_by_id; // struct sway_container * by size_t id
+	hash_table_t *views_by_mark; // struct sway_view * by mark
+
+	// Incremented whenever the layout may have changed, so results computed
+	// from it can be reused while it stays the same
+	uint64_t generation;
+
 	struct {
 		struct wl_signal new_container;
 	} events;
@@ -75,4 +83,17 @@ struct sway_container *root_find_workspace(
 struct sway_container *root_find_container(
 		bool (*test)(struct sway_container *con, void *data), void *data);
 
+/**
+ * Add a container to or remove it from the id index.
+ */
+void root_add_container_id(struct sway_container *con);
+
+void root_remove_container_id(struct sway_container *con);
+
+/**
+ * Find a container by id in constant time. Containers which are being
+ * destroyed aren't returned.
+ */
+struct sway_container *root_find_container_by_id(size_t id);
+
 #endif
@@ -32,6 +32,39 @@ enum sway_view_prop {
 #endif
 };
 
+/**
+ * Bitmask of view properties which criteria can depend on. When a property
+ * changes, only criteria depending on it need to be tested again.
+ */
+enum sway_view_prop_mask {
+	VIEW_MASK_TITLE       = 1 << 0,
+	VIEW_MASK_SHELL       = 1 << 1,
+	VIEW_MASK_APP_ID      = 1 << 2,
+	VIEW_MASK_CLASS       = 1 << 3,
+	VIEW_MASK_INSTANCE    = 1 << 4,
+	VIEW_MASK_MARK        = 1 << 5,
+	VIEW_MASK_CON_ID      = 1 << 6,
+	VIEW_MASK_X11_ID      = 1 << 7,
+	VIEW_MASK_WINDOW_ROLE = 1 << 8,
+	VIEW_MASK_WINDOW_TYPE = 1 << 9,
+	VIEW_MASK_FLOATING    = 1 << 10,
+	VIEW_MASK_URGENT      = 1 << 11,
+	VIEW_MASK_WORKSPACE   = 1 << 12,
+	VIEW_MASK_ALL         = (1 << 13) - 1,
+	// Properties whose changes don't trigger criteria evaluation, so criteria
+	// depending on them are tested whenever any property changes
+	VIEW_MASK_UNTRACKED   =
+		VIEW_MASK_FLOATING | VIEW_MASK_URGENT | VIEW_MASK_WORKSPACE,
+};
+
+struct sway_saved_buffer {
+	struct wlr_buffer *buffer;
+	int x, y; // Relative to the view's main surface
+	int width, height;
+	enum wl_output_transform transform;
+	struct wl_list link; // sway_view::saved_buffers
+};
+
 struct sway_view_impl {
 	void (*get_constraints)(struct sway_view *view, double *min_width,
 			double *max_width, double *min_height, double *max_height);
@@ -85,8 +118,9 @@ struct sway_view {
 	bool allow_request_urgent;
 	struct wl_event_source *urgent_timer;
 
-	struct wlr_buffer *saved_buffer;
-	int saved_buffer_width, saved_buffer_height;
+	// Buffers of the view's surface tree (main surface and subsurfaces) which
+	// are rendered instead of the live surfaces while a configure is pending.
+	struct wl_list saved_buffers; // sway_saved_buffer::link
 
 	// The geometry for whatever the client is committing, regardless of
 	// transaction state. Updated on every commit.
@@ -320,9 +354,10 @@ void view_update_title(struct sway_view *view, bool force);
 
 /**
  * Run any criteria that match the view and haven't been run on this view
- * before.
+ * before. Only criteria depending on a property in the changed mask are
+ * tested; pass VIEW_MASK_ALL to test them all.
  */
-void view_execute_criteria(struct sway_view *view);
+void view_execute_criteria(struct sway_view *view, uint32_t changed);
 
 /**
  * Find any view that has the given mark and return it.
@@ -356,8 +391,13 @@ void view_set_urgent(struct sway_view *view, bool enable);
 
 bool view_is_urgent(struct sway_view *view);
 
+bool view_has_saved_buffer(struct sway_view *view);
+
 void view_remove_saved_buffer(struct sway_view *view);
 
+/**
+ * Save references to the buffers of the view's surface and its subsurfaces.
+ */
 void view_save_buffer(struct sway_view *view);
 
 #endif
@@ -13,6 +13,7 @@
 #include "sway/input/input-manager.h"
 #include "sway/input/seat.h"
 #include "sway/tree/view.h"
+#include "hash_table.h"
 #include "stringop.h"
 #include "log.h"
 
@@ -68,7 +69,10 @@ void apply_input_config(struct input_config *input) {
 		list_add(config->input_configs, input);
 	}
 
-	input_manager_apply_input_config(input_manager, input);
+	// When reloading, only the configs which changed are applied afterwards
+	if (!config->reloading) {
+		input_manager_apply_input_config(input_manager, input);
+	}
 }
 
 void apply_seat_config(struct seat_config *seat_config) {
@@ -84,7 +88,9 @@ void apply_seat_config(struct seat_config *seat_config) {
 		list_add(config->seat_configs, seat_config);
 	}
 
-	input_manager_apply_seat_config(input_manager, seat_config);
+	if (!config->reloading) {
+		input_manager_apply_seat_config(input_manager, seat_config);
+	}
 }
 
 /* Keep alphabetized */
@@ -163,24 +169,72 @@ static struct cmd_handler command_handlers[] = {
 	{ "urgent", cmd_urgent },
 };
 
-static int handler_compare(const void *_a, const void *_b) {
-	const struct cmd_handler *a = _a;
-	const struct cmd_handler *b = _b;
-	return strcasecmp(a->command, b->command);
+/**
+ * Hash indexes over the handler tables, keyed by the table's address and
+ * built the first time a table is searched. Names are stored lowercased as
+ * commands are case insensitive.
+ */
+static hash_table_t *handler_indexes = NULL;
+
+// Longer than any handler name
+#define HANDLER_NAME_MAX 64
+
+static hash_table_t *get_handler_index(struct cmd_handler *table,
+		size_t count) {
+	if (!handler_indexes) {
+		handler_indexes = create_hash_table();
+		if (!handler_indexes) {
+			return NULL;
+		}
+	}
+	hash_table_t *index =
+		hash_table_get(handler_indexes, &table, sizeof(table));
+	if (index) {
+		return index;
+	}
+	index = create_hash_table();
+	if (!index) {
+		return NULL;
+	}
+	for (size_t i = 0; i < count; ++i) {
+		char name[HANDLER_NAME_MAX];
+		size_t len = strlen(table[i].command);
+		if (!sway_assert(len < HANDLER_NAME_MAX, "Handler name too long")) {
+			continue;
+		}
+		for (size_t j = 0; j < len; ++j) {
+			name[j] = tolower((unsigned char)table[i].command[j]);
+		}
+		hash_table_set(index, name, len, &table[i]);
+	}
+	hash_table_set(handler_indexes, &table, sizeof(table), index);
+	return index;
+}
+
+static struct cmd_handler *find_handler_in(struct cmd_handler *table,
+		size_t count, const char *line) {
+	char name[HANDLER_NAME_MAX];
+	size_t len = strlen(line);
+	if (len >= HANDLER_NAME_MAX) {
+		return NULL;
+	}
+	for (size_t i = 0; i < len; ++i) {
+		name[i] = tolower((unsigned char)line[i]);
+	}
+	hash_table_t *index = get_handler_index(table, count);
+	return index ? hash_table_get(index, name, len) : NULL;
 }
 
 struct cmd_handler *find_handler(char *line, struct cmd_handler *cmd_handlers,
 		int handlers_size) {
-	struct cmd_handler d = { .command=line };
 	struct cmd_handler *res = NULL;
 	wlr_log(WLR_DEBUG, "find_handler(%s)", line);
 
 	bool config_loading = config->reading || !config->active;
 
 	if (!config_loading) {
-		res = bsearch(&d, command_handlers,
-				sizeof(command_handlers) / sizeof(struct cmd_handler),
-				sizeof(struct cmd_handler), handler_compare);
+		res = find_handler_in(command_handlers,
+				sizeof(command_handlers) / sizeof(struct cmd_handler), line);
 
 		if (res) {
 			return res;
@@ -188,9 +242,8 @@ struct cmd_handler *find_handler(char *line, struct cmd_handler *cmd_handlers,
 	}
 
 	if (config->reading) {
-		res = bsearch(&d, config_handlers,
-				sizeof(config_handlers) / sizeof(struct cmd_handler),
-				sizeof(struct cmd_handler), handler_compare);
+		res = find_handler_in(config_handlers,
+				sizeof(config_handlers) / sizeof(struct cmd_handler), line);
 
 		if (res) {
 			return res;
@@ -202,13 +255,47 @@ struct cmd_handler *find_handler(char *line, struct cmd_handler *cmd_handlers,
 		handlers_size = sizeof(handlers);
 	}
 
-	res = bsearch(&d, cmd_handlers,
-			handlers_size / sizeof(struct cmd_handler),
-			sizeof(struct cmd_handler), handler_compare);
+	res = find_handler_in(cmd_handlers,
+			handlers_size / sizeof(struct cmd_handler), line);
 
 	return res;
 }
 
+/**
+ * Runs a handler on the focused container, or on each of the views matched by
+ * the command list's criteria. Returns the failed result, or NULL on success.
+ */
+static struct cmd_results *run_handler(struct sway_seat *seat,
+		struct cmd_handler *handler, int argc, char **argv, list_t *views) {
+	if (!config->handler_context.using_criteria) {
+		// without criteria, the command acts upon the focused
+		// container
+		config->handler_context.current_container =
+			seat_get_focus_inactive(seat, &root_container);
+		if (!sway_assert(config->handler_context.current_container,
+				"could not get focus-inactive for root container")) {
+			return cmd_results_new(CMD_FAILURE, argv[0],
+					"Unable to find a focused container");
+		}
+		struct cmd_results *res = handler->handle(argc-1, argv+1);
+		if (res->status != CMD_SUCCESS) {
+			return res;
+		}
+		free_cmd_results(res);
+	} else {
+		for (int i = 0; i < views->length; ++i) {
+			struct sway_view *view = views->items[i];
+			config->handler_context.current_container = view->swayc;
+			struct cmd_results *res = handler->handle(argc-1, argv+1);
+			if (res->status != CMD_SUCCESS) {
+				return res;
+			}
+			free_cmd_results(res);
+		}
+	}
+	return NULL;
+}
+
 struct cmd_results *execute_command(char *_exec, struct sway_seat *seat) {
 	// Even though this function will process multiple commands we will only
 	// return the last error, if any (for now). (Since we have access to an
@@ -289,42 +376,16 @@ struct cmd_results *execute_command(char *_exec, struct sway_seat *seat) {
 				unescape_string(argv[i]);
 			}
 
-			if (!config->handler_context.using_criteria) {
-				// without criteria, the command acts upon the focused
-				// container
-				config->handler_context.current_container =
-					seat_get_focus_inactive(seat, &root_container);
-				if (!sway_assert(config->handler_context.current_container,
-						"could not get focus-inactive for root container")) {
-					return NULL;
-				}
-				struct cmd_results *res = handler->handle(argc-1, argv+1);
-				if (res->status != CMD_SUCCESS) {
-					free_argv(argc, argv);
-					if (results) {
-						free_cmd_results(results);
-					}
-					results = res;
-					goto cleanup;
-				}
-				free_cmd_results(res);
-			} else {
-				for (int i = 0; i < views->length; ++i) {
-					struct sway_view *view = views->items[i];
-					config->handler_context.current_container = view->swayc;
-					struct cmd_results *res = handler->handle(argc-1, argv+1);
-					if (res->status != CMD_SUCCESS) {
-						free_argv(argc, argv);
-						if (results) {
-							free_cmd_results(results);
-						}
-						results = res;
-						goto cleanup;
-					}
-					free_cmd_results(res);
+			struct cmd_results *res =
+				run_handler(seat, handler, argc, argv, views);
+			free_argv(argc, argv);
+			if (res) {
+				if (results) {
+					free_cmd_results(results);
 				}
+				results = res;
+				goto cleanup;
 			}
-			free_argv(argc, argv);
 		} while(cmdlist);
 	} while(head);
 cleanup:
@@ -336,6 +397,191 @@ cleanup:
 	return results;
 }
 
+struct compiled_cmd {
+	char *input; // for logging
+	struct cmd_handler *handler;
+	int argc;
+	char **argv;
+	int first_var; // first argument subject to variable replacement
+	bool has_vars; // variable replacement is deferred until execution
+};
+
+struct compiled_cmdlist {
+	struct criteria *criteria; // NULL if the list has no criteria
+	list_t *cmds; // struct compiled_cmd *
+};
+
+struct compiled_command {
+	list_t *cmdlists; // struct compiled_cmdlist *
+};
+
+void free_compiled_command(struct compiled_command *compiled) {
+	if (!compiled) {
+		return;
+	}
+	for (int i = 0; i < compiled->cmdlists->length; ++i) {
+		struct compiled_cmdlist *cmdlist = compiled->cmdlists->items[i];
+		for (int j = 0; j < cmdlist->cmds->length; ++j) {
+			struct compiled_cmd *cmd = cmdlist->cmds->items[j];
+			free_argv(cmd->argc, cmd->argv);
+			free(cmd->input);
+			free(cmd);
+		}
+		list_free(cmdlist->cmds);
+		if (cmdlist->criteria) {
+			criteria_destroy(cmdlist->criteria);
+		}
+		free(cmdlist);
+	}
+	list_free(compiled->cmdlists);
+	free(compiled);
+}
+
+bool compiled_command_has_handler(struct compiled_command *compiled,
+		sway_cmd *handle) {
+	for (int i = 0; i < compiled->cmdlists->length; ++i) {
+		struct compiled_cmdlist *cmdlist = compiled->cmdlists->items[i];
+		for (int j = 0; j < cmdlist->cmds->length; ++j) {
+			struct compiled_cmd *cmd = cmdlist->cmds->items[j];
+			if (cmd->handler->handle == handle) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+struct compiled_command *compile_command(const char *_exec) {
+	struct compiled_command *compiled =
+		calloc(1, sizeof(struct compiled_command));
+	if (!compiled) {
+		return NULL;
+	}
+	compiled->cmdlists = create_list();
+	char *exec = strdup(_exec);
+	char *head = exec;
+	do {
+		struct compiled_cmdlist *cmdlist =
+			calloc(1, sizeof(struct compiled_cmdlist));
+		cmdlist->cmds = create_list();
+		list_add(compiled->cmdlists, cmdlist);
+		if (*head == '[') {
+			char *error = NULL;
+			cmdlist->criteria = criteria_parse(head, &error);
+			if (!cmdlist->criteria) {
+				free(error);
+				goto error;
+			}
+			// __focused__ is resolved when the criteria is parsed
+			if (strstr(cmdlist->criteria->raw, "__focused__")) {
+				goto error;
+			}
+			head += strlen(cmdlist->criteria->raw);
+			head += strspn(head, whitespace);
+		}
+		char *cmds = argsep(&head, ";");
+		cmds += strspn(cmds, whitespace);
+		do {
+			char *cmd = argsep(&cmds, ",");
+			cmd += strspn(cmd, whitespace);
+			if (strcmp(cmd, "") == 0) {
+				continue;
+			}
+			int argc;
+			char **argv = split_args(cmd, &argc);
+			if (strcmp(argv[0], "exec") != 0) {
+				for (int i = 1; i < argc; ++i) {
+					if (*argv[i] == '\"' || *argv[i] == '\'') {
+						strip_quotes(argv[i]);
+					}
+				}
+			}
+			struct cmd_handler *handler = find_handler(argv[0], NULL, 0);
+			// Reloading and replacing bindings free the binding or criteria
+			// owning the compiled command while it's executing, so leave
+			// those to execute_command
+			if (!handler || handler->handle == cmd_reload ||
+					handler->handle == cmd_bindsym ||
+					handler->handle == cmd_bindcode) {
+				free_argv(argc, argv);
+				goto error;
+			}
+
+			struct compiled_cmd *compiled_cmd =
+				calloc(1, sizeof(struct compiled_cmd));
+			compiled_cmd->input = strdup(cmd);
+			compiled_cmd->handler = handler;
+			compiled_cmd->argc = argc;
+			compiled_cmd->argv = argv;
+			compiled_cmd->first_var = handler->handle == cmd_set ? 2 : 1;
+			// Variables can be changed at runtime with `set`, so only
+			// arguments without any are finished here
+			for (int i = compiled_cmd->first_var; i < argc; ++i) {
+				if (strchr(argv[i], '$')) {
+					compiled_cmd->has_vars = true;
+					break;
+				}
+			}
+			if (!compiled_cmd->has_vars) {
+				for (int i = compiled_cmd->first_var; i < argc; ++i) {
+					unescape_string(argv[i]);
+				}
+			}
+			list_add(cmdlist->cmds, compiled_cmd);
+		} while (cmds);
+	} while (head);
+	free(exec);
+	return compiled;
+
+error:
+	free(exec);
+	free_compiled_command(compiled);
+	return NULL;
+}
+
+struct cmd_results *execute_compiled_command(
+		struct compiled_command *compiled, struct sway_seat *seat) {
+	if (seat == NULL) {
+		seat = input_manager_get_default_seat(input_manager);
+		if (!sway_assert(seat, "could not find a seat to run the command on")) {
+			return NULL;
+		}
+	}
+	config->handler_context.seat = seat;
+
+	for (int i = 0; i < compiled->cmdlists->length; ++i) {
+		struct compiled_cmdlist *cmdlist = compiled->cmdlists->items[i];
+		list_t *views = NULL;
+		config->handler_context.using_criteria = cmdlist->criteria != NULL;
+		if (cmdlist->criteria) {
+			views = criteria_get_views(cmdlist->criteria);
+		}
+		for (int j = 0; j < cmdlist->cmds->length; ++j) {
+			struct compiled_cmd *cmd = cmdlist->cmds->items[j];
+			wlr_log(WLR_INFO, "Handling command '%s'", cmd->input);
+			// Handlers are free to modify their arguments
+			char **argv = malloc(sizeof(char *) * (cmd->argc + 1));
+			for (int k = 0; k < cmd->argc; ++k) {
+				argv[k] = strdup(cmd->argv[k]);
+				if (cmd->has_vars && k >= cmd->first_var) {
+					argv[k] = do_var_replacement(argv[k]);
+					unescape_string(argv[k]);
+				}
+			}
+			argv[cmd->argc] = NULL;
+			struct cmd_results *res =
+				run_handler(seat, cmd->handler, cmd->argc, argv, views);
+			free_argv(cmd->argc, argv);
+			if (res) {
+				list_free(views);
+				return res;
+			}
+		}
+		list_free(views);
+	}
+	return cmd_results_new(CMD_SUCCESS, NULL, NULL);
+}
+
 // this is like execute_command above, except:
 // 1) it ignores empty commands (empty lines)
 // 2) it does variable substitution
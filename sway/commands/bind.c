@@ -6,11 +6,15 @@
 #endif
 #include <xkbcommon/xkbcommon.h>
 #include <xkbcommon/xkbcommon-names.h>
+#include <stdlib.h>
 #include <string.h>
 #include <strings.h>
+#include <wayland-server-core.h>
 #include "sway/commands.h"
 #include "sway/config.h"
+#include "sway/desktop/transaction.h"
 #include "sway/ipc-server.h"
+#include "sway/server.h"
 #include "list.h"
 #include "log.h"
 #include "stringop.h"
@@ -18,15 +22,20 @@
 
 int binding_order = 0;
 
+static void cancel_deferred_commands(struct sway_seat *seat,
+		struct sway_binding *binding);
+
 void free_sway_binding(struct sway_binding *binding) {
 	if (!binding) {
 		return;
 	}
+	cancel_deferred_commands(NULL, binding);
 
 	if (binding->keys) {
 		free_flat_list(binding->keys);
 	}
 	free(binding->command);
+	free_compiled_command(binding->compiled);
 	free(binding);
 }
 
@@ -96,6 +105,63 @@ static bool binding_key_compare(struct sway_binding *binding_a,
 	return true;
 }
 
+// Bindings with more keys than this can't be pressed at once
+#define BINDING_INDEX_KEYS_MAX 32
+
+static hash_table_t *mode_binding_index(struct sway_mode *mode,
+		enum binding_input_type type) {
+	switch (type) {
+	case BINDING_KEYCODE:
+		return mode->keycode_index;
+	case BINDING_KEYSYM:
+		return mode->keysym_index;
+	case BINDING_MOUSE:
+		break;
+	}
+	return NULL;
+}
+
+/**
+ * Write the index key of a key combination into buf, which must have room for
+ * keys_len + 2 values. Returns the size of the key in bytes.
+ */
+static size_t binding_index_key(uint32_t *buf, uint32_t modifiers,
+		bool release, const uint32_t *keys, size_t keys_len) {
+	buf[0] = modifiers;
+	buf[1] = release;
+	memcpy(buf + 2, keys, keys_len * sizeof(uint32_t));
+	return (keys_len + 2) * sizeof(uint32_t);
+}
+
+static bool mode_index_binding(struct sway_mode *mode,
+		struct sway_binding *binding) {
+	hash_table_t *index = mode_binding_index(mode, binding->type);
+	size_t keys_len = binding->keys->length;
+	if (!index || keys_len > BINDING_INDEX_KEYS_MAX) {
+		return true;
+	}
+	uint32_t keys[BINDING_INDEX_KEYS_MAX];
+	for (size_t i = 0; i < keys_len; ++i) {
+		keys[i] = *(uint32_t *)binding->keys->items[i];
+	}
+	uint32_t buf[BINDING_INDEX_KEYS_MAX + 2];
+	size_t len = binding_index_key(buf, binding->modifiers,
+			binding->flags & BINDING_RELEASE, keys, keys_len);
+	return hash_table_set(index, buf, len, binding);
+}
+
+struct sway_binding *mode_find_binding(struct sway_mode *mode,
+		enum binding_input_type type, uint32_t modifiers, bool release,
+		const uint32_t *keys, size_t keys_len) {
+	hash_table_t *index = mode_binding_index(mode, type);
+	if (!index || keys_len > BINDING_INDEX_KEYS_MAX) {
+		return NULL;
+	}
+	uint32_t buf[BINDING_INDEX_KEYS_MAX + 2];
+	size_t len = binding_index_key(buf, modifiers, release, keys, keys_len);
+	return hash_table_get(index, buf, len);
+}
+
 static int key_qsort_cmp(const void *keyp_a, const void *keyp_b) {
 	uint32_t key_a = **(uint32_t **)keyp_a;
 	uint32_t key_b = **(uint32_t **)keyp_b;
@@ -283,6 +349,9 @@ static struct cmd_results *cmd_bindsym_or_bindcode(int argc, char **argv,
 	if (!overwritten) {
 		list_add(mode_bindings, binding);
 	}
+	if (!mode_index_binding(config->current_mode, binding)) {
+		wlr_log(WLR_ERROR, "Unable to index binding, it won't be triggered");
+	}
 
 	wlr_log(WLR_DEBUG, "%s - Bound %s to command %s",
 		bindtype, argv[0], binding->command);
@@ -299,6 +368,13 @@ struct cmd_results *cmd_bindcode(int argc, char **argv) {
 }
 
 
+static void binding_compile(struct sway_binding *binding) {
+	if (!binding->compiled && !binding->uncompilable) {
+		binding->compiled = compile_command(binding->command);
+		binding->uncompilable = !binding->compiled;
+	}
+}
+
 /**
  * Execute the command associated to a binding
  */
@@ -306,30 +382,117 @@ void seat_execute_command(struct sway_seat *seat, struct sway_binding *binding)
 	wlr_log(WLR_DEBUG, "running command for binding: %s",
 		binding->command);
 
+	binding_compile(binding);
+
+	// Commands which aren't compiled, such as reload or bindsym, may free the
+	// binding while they run, so they use a duplicate of it
 	struct sway_binding *binding_copy = binding;
-	bool reload = false;
-	// if this is a reload command we need to make a duplicate of the
-	// binding since it will be gone after the reload has completed.
-	if (strcasecmp(binding->command, "reload") == 0) {
-		reload = true;
+	if (!binding->compiled) {
 		binding_copy = sway_binding_dup(binding);
 		if (!binding_copy) {
-			wlr_log(WLR_ERROR, "Failed to duplicate binding during reload");
+			wlr_log(WLR_ERROR, "Failed to duplicate binding");
 			return;
 		}
 	}
 
 	config->handler_context.seat = seat;
-	struct cmd_results *results = execute_command(binding->command, NULL);
+	struct cmd_results *results = binding->compiled ?
+		execute_compiled_command(binding->compiled, NULL) :
+		execute_command(binding_copy->command, NULL);
 	if (results->status == CMD_SUCCESS) {
 		ipc_event_binding(binding_copy);
 	} else {
 		wlr_log(WLR_DEBUG, "could not run command for binding: %s (%s)",
-			binding->command, results->error);
+			binding_copy->command, results->error);
 	}
 
-	if (reload) { // free the binding if we made a copy
+	if (binding_copy != binding) { // free the binding if we made a copy
 		free_sway_binding(binding_copy);
 	}
 	free_cmd_results(results);
 }
+
+struct deferred_binding {
+	struct sway_seat *seat;
+	struct sway_binding *binding;
+};
+
+static list_t *deferred_bindings = NULL; // struct deferred_binding
+static struct wl_event_source *deferred_idle = NULL;
+
+/**
+ * Returns true if any command of the binding must run before further input is
+ * handled. Commands which can't be compiled, such as reload or bindsym, free
+ * bindings and always run immediately.
+ */
+static bool binding_is_synchronous(struct sway_binding *binding) {
+	binding_compile(binding);
+	if (!binding->compiled) {
+		return true;
+	}
+	// These change how the following input is handled
+	return compiled_command_has_handler(binding->compiled, cmd_mode) ||
+		compiled_command_has_handler(binding->compiled, cmd_input) ||
+		compiled_command_has_handler(binding->compiled, cmd_seat);
+}
+
+static void handle_deferred_idle(void *data) {
+	deferred_idle = NULL;
+	execute_deferred_commands();
+	transaction_commit_dirty();
+}
+
+void seat_execute_command_deferred(struct sway_seat *seat,
+		struct sway_binding *binding) {
+	if (binding_is_synchronous(binding)) {
+		execute_deferred_commands();
+		seat_execute_command(seat, binding);
+		return;
+	}
+
+	struct deferred_binding *deferred = malloc(sizeof(*deferred));
+	if (!deferred) {
+		wlr_log(WLR_ERROR, "Unable to allocate deferred binding");
+		seat_execute_command(seat, binding);
+		return;
+	}
+	deferred->seat = seat;
+	deferred->binding = binding;
+	if (!deferred_bindings) {
+		deferred_bindings = create_list();
+	}
+	list_add(deferred_bindings, deferred);
+
+	if (!deferred_idle) {
+		deferred_idle = wl_event_loop_add_idle(server.wl_event_loop,
+				handle_deferred_idle, NULL);
+	}
+}
+
+void execute_deferred_commands(void) {
+	// Commands may remove any of the queued bindings, so always take the first
+	while (deferred_bindings && deferred_bindings->length) {
+		struct deferred_binding *deferred = deferred_bindings->items[0];
+		list_del(deferred_bindings, 0);
+		seat_execute_command(deferred->seat, deferred->binding);
+		free(deferred);
+	}
+}
+
+static void cancel_deferred_commands(struct sway_seat *seat,
+		struct sway_binding *binding) {
+	if (!deferred_bindings) {
+		return;
+	}
+	for (int i = deferred_bindings->length - 1; i >= 0; --i) {
+		struct deferred_binding *deferred = deferred_bindings->items[i];
+		if (deferred->seat == seat || deferred->binding == binding) {
+			list_del(deferred_bindings, i);
+			free(deferred);
+		}
+	}
+}
+
+void seat_cancel_deferred_commands(struct sway_seat *seat) {
+	cancel_deferred_commands(seat, NULL);
+}
@@ -22,6 +22,9 @@ struct cmd_results *cmd_font(int argc, char **argv) {
 	}
 
 	free(font);
-	config_update_font_height(true);
+	// When reloading, titles are updated once the whole config is read
+	if (!config->reloading) {
+		config_update_font_height(true);
+	}
 	return cmd_results_new(CMD_SUCCESS, NULL, NULL);
 }
@@ -23,7 +23,7 @@ struct cmd_results *cmd_for_window(int argc, char **argv) {
 	criteria->type = CT_COMMAND;
 	criteria->cmdlist = join_args(argv + 1, argc - 1);
 
-	list_add(config->criteria, criteria);
+	criteria_add(criteria);
 	wlr_log(WLR_DEBUG, "for_window: '%s' -> '%s' added", criteria->raw, criteria->cmdlist);
 
 	return cmd_results_new(CMD_SUCCESS, NULL, NULL);
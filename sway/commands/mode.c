@@ -57,6 +57,8 @@ struct cmd_results *cmd_mode(int argc, char **argv) {
 		mode->keysym_bindings = create_list();
 		mode->keycode_bindings = create_list();
 		mode->mouse_bindings = create_list();
+		mode->keysym_index = create_hash_table();
+		mode->keycode_index = create_hash_table();
 		mode->pango = pango;
 		list_add(config->modes, mode);
 	}
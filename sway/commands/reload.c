@@ -5,6 +5,7 @@
 #include "sway/ipc-server.h"
 #include "sway/tree/arrange.h"
 #include "list.h"
+#include "stringop.h"
 
 struct cmd_results *cmd_reload(int argc, char **argv) {
 	struct cmd_results *error = NULL;
@@ -19,16 +20,19 @@ struct cmd_results *cmd_reload(int argc, char **argv) {
 		list_add(bar_ids, strdup(bar->id));
 	}
 
-	if (!load_main_config(config->current_config_path, true, false)) {
+	if (!load_main_config(config->current_config_path, true, false, false)) {
+		free_flat_list(bar_ids);
 		return cmd_results_new(CMD_FAILURE, "reload",
 				"Error(s) reloading config.");
 	}
 	ipc_event_workspace(NULL, NULL, "reload");
 
-	load_swaybars();
-
+	// Bars which are still running were unchanged and kept their swaybar
 	for (int i = 0; i < config->bars->length; ++i) {
 		struct bar_config *bar = config->bars->items[i];
+		if (bar->pid != 0) {
+			continue;
+		}
 		for (int j = 0; j < bar_ids->length; ++j) {
 			if (strcmp(bar->id, bar_ids->items[j]) == 0) {
 				ipc_event_barconfig_update(bar);
@@ -36,11 +40,9 @@ struct cmd_results *cmd_reload(int argc, char **argv) {
 			}
 		}
 	}
+	free_flat_list(bar_ids);
 
-	for (int i = 0; i < bar_ids->length; ++i) {
-		free(bar_ids->items[i]);
-	}
-	list_free(bar_ids);
+	load_new_swaybars();
 
 	arrange_windows(&root_container);
 
@@ -10,6 +10,8 @@ static struct cmd_handler seat_handlers[] = {
 	{ "attach", seat_cmd_attach },
 	{ "cursor", seat_cmd_cursor },
 	{ "fallback", seat_cmd_fallback },
+	{ "motion_coalescing", seat_cmd_motion_coalescing },
+	{ "pointer_constraint", seat_cmd_pointer_constraint },
 };
 
 struct cmd_results *cmd_seat(int argc, char **argv) {
@@ -0,0 +1,38 @@
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "sway/config.h"
+#include "sway/commands.h"
+#include "sway/input/input-manager.h"
+
+struct cmd_results *seat_cmd_motion_coalescing(int argc, char **argv) {
+	struct cmd_results *error = NULL;
+	if ((error = checkarg(argc, "motion_coalescing", EXPECTED_EQUAL_TO, 1))) {
+		return error;
+	}
+	struct seat_config *current_seat_config =
+		config->handler_context.seat_config;
+	if (!current_seat_config) {
+		return cmd_results_new(CMD_FAILURE, "motion_coalescing",
+				"No seat defined");
+	}
+	struct seat_config *new_config =
+		new_seat_config(current_seat_config->name);
+
+	char *end;
+	if (strcasecmp(argv[0], "disable") == 0) {
+		new_config->motion_coalescing = MOTION_COALESCING_DISABLE;
+	} else if (strcasecmp(argv[0], "frame") == 0) {
+		new_config->motion_coalescing = MOTION_COALESCING_FRAME;
+	} else if ((new_config->motion_rate = strtol(argv[0], &end, 10)) > 0
+			&& *end == '\0') {
+		new_config->motion_coalescing = MOTION_COALESCING_RATE;
+	} else {
+		free_seat_config(new_config);
+		return cmd_results_new(CMD_INVALID, "motion_coalescing",
+			"Expected 'motion_coalescing <disable|frame|rate>'");
+	}
+
+	apply_seat_config(new_config);
+	return cmd_results_new(CMD_SUCCESS, NULL, NULL);
+}
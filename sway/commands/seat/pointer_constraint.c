@@ -0,0 +1,54 @@
+#include <string.h>
+#include <strings.h>
+#include "sway/config.h"
+#include "sway/commands.h"
+#include "sway/input/cursor.h"
+#include "sway/input/input-manager.h"
+#include "sway/input/seat.h"
+
+static struct cmd_results *escape_constraint(const char *seat_name) {
+	if (!config->active) {
+		return cmd_results_new(CMD_FAILURE, "pointer_constraint",
+				"Can only escape a pointer constraint at runtime");
+	}
+	struct sway_seat *seat;
+	wl_list_for_each(seat, &input_manager->seats, link) {
+		if (strcmp(seat_name, "*") == 0 ||
+				strcmp(seat->wlr_seat->name, seat_name) == 0) {
+			cursor_constrain(seat->cursor, NULL);
+		}
+	}
+	return cmd_results_new(CMD_SUCCESS, NULL, NULL);
+}
+
+struct cmd_results *seat_cmd_pointer_constraint(int argc, char **argv) {
+	struct cmd_results *error = NULL;
+	if ((error = checkarg(argc, "pointer_constraint", EXPECTED_EQUAL_TO, 1))) {
+		return error;
+	}
+	struct seat_config *current_seat_config =
+		config->handler_context.seat_config;
+	if (!current_seat_config) {
+		return cmd_results_new(CMD_FAILURE, "pointer_constraint",
+				"No seat defined");
+	}
+
+	if (strcasecmp(argv[0], "escape") == 0) {
+		return escape_constraint(current_seat_config->name);
+	}
+
+	struct seat_config *new_config =
+		new_seat_config(current_seat_config->name);
+	if (strcasecmp(argv[0], "enable") == 0) {
+		new_config->pointer_constraint = POINTER_CONSTRAINT_ENABLE;
+	} else if (strcasecmp(argv[0], "disable") == 0) {
+		new_config->pointer_constraint = POINTER_CONSTRAINT_DISABLE;
+	} else {
+		free_seat_config(new_config);
+		return cmd_results_new(CMD_INVALID, "pointer_constraint",
+			"Expected 'pointer_constraint <enable|disable|escape>'");
+	}
+
+	apply_seat_config(new_config);
+	return cmd_results_new(CMD_SUCCESS, NULL, NULL);
+}
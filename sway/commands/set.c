@@ -8,13 +8,6 @@
 #include "log.h"
 #include "stringop.h"
 
-// sort in order of longest->shortest
-static int compare_set_qsort(const void *_l, const void *_r) {
-	struct sway_variable const *l = *(void **)_l;
-	struct sway_variable const *r = *(void **)_r;
-	return strlen(r->name) - strlen(l->name);
-}
-
 void free_sway_variable(struct sway_variable *var) {
 	if (!var) {
 		return;
@@ -52,8 +45,13 @@ struct cmd_results *cmd_set(int argc, char **argv) {
 			return cmd_results_new(CMD_FAILURE, "set", "Unable to allocate variable");
 		}
 		var->name = strdup(argv[0]);
+		var->value = NULL;
+		if (!variable_trie_add(config->symbols_trie, var)) {
+			free_sway_variable(var);
+			return cmd_results_new(CMD_FAILURE, "set",
+					"Unable to allocate variable");
+		}
 		list_add(config->symbols, var);
-		list_qsort(config->symbols, compare_set_qsort);
 	}
 	var->value = join_args(argv + 1, argc - 1);
 	return cmd_results_new(CMD_SUCCESS, NULL, NULL);
@@ -136,10 +136,6 @@ static void container_swap(struct sway_container *con1,
 	}
 }
 
-static bool test_con_id(struct sway_container *container, void *con_id) {
-	return container->id == (size_t)con_id;
-}
-
 static bool test_id(struct sway_container *container, void *id) {
 #ifdef HAVE_XWAYLAND
 	xcb_window_t *wid = id;
@@ -151,14 +147,6 @@ static bool test_id(struct sway_container *container, void *id) {
 #endif
 }
 
-static bool test_mark(struct sway_container *container, void *mark) {
-	if (container->type == C_VIEW && container->sway_view->marks->length) {
-		return !list_seq_find(container->sway_view->marks,
-				(int (*)(const void *, const void *))strcmp, mark);
-	}
-	return false;
-}
-
 struct cmd_results *cmd_swap(int argc, char **argv) {
 	struct cmd_results *error = NULL;
 	if ((error = checkarg(argc, "swap", EXPECTED_AT_LEAST, 4))) {
@@ -180,9 +168,10 @@ struct cmd_results *cmd_swap(int argc, char **argv) {
 #endif
 	} else if (strcasecmp(argv[2], "con_id") == 0) {
 		size_t con_id = atoi(value);
-		other = root_find_container(test_con_id, (void *)con_id);
+		other = root_find_container_by_id(con_id);
 	} else if (strcasecmp(argv[2], "mark") == 0) {
-		other = root_find_container(test_mark, (void *)value);
+		struct sway_view *view = view_find_mark(value);
+		other = view ? view->swayc : NULL;
 	} else {
 		free(value);
 		return cmd_results_new(CMD_INVALID, "swap", EXPECTED_SYNTAX);
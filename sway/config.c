@@ -27,11 +27,11 @@
 #include "sway/criteria.h"
 #include "sway/swaynag.h"
 #include "sway/tree/arrange.h"
+#include "sway/tree/container.h"
 #include "sway/tree/root.h"
 #include "sway/tree/workspace.h"
 #include "cairo.h"
 #include "pango.h"
-#include "readline.h"
 #include "stringop.h"
 #include "list.h"
 #include "log.h"
@@ -57,6 +57,8 @@ static void free_mode(struct sway_mode *mode) {
 		}
 		list_free(mode->keycode_bindings);
 	}
+	hash_table_free(mode->keysym_index);
+	hash_table_free(mode->keycode_index);
 	if (mode->mouse_bindings) {
 		for (i = 0; i < mode->mouse_bindings->length; i++) {
 			free_sway_binding(mode->mouse_bindings->items[i]);
@@ -66,6 +68,108 @@ static void free_mode(struct sway_mode *mode) {
 	free(mode);
 }
 
+static uint64_t get_time_nsec(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static struct config_profile *config_profile_create(void) {
+	struct config_profile *profile = calloc(1, sizeof(struct config_profile));
+	if (!profile) {
+		return NULL;
+	}
+	profile->commands = create_hash_table();
+	profile->files = create_list();
+	return profile;
+}
+
+static void free_profile_entry(struct config_profile_entry *entry) {
+	free(entry->name);
+	free(entry);
+}
+
+static void free_profile_command(const void *key, size_t key_len,
+		void *value, void *data) {
+	free_profile_entry(value);
+}
+
+static void config_profile_destroy(struct config_profile *profile) {
+	if (!profile) {
+		return;
+	}
+	hash_table_foreach(profile->commands, free_profile_command, NULL);
+	hash_table_free(profile->commands);
+	for (int i = 0; i < profile->files->length; ++i) {
+		free_profile_entry(profile->files->items[i]);
+	}
+	list_free(profile->files);
+	free(profile);
+}
+
+static struct config_profile_entry *create_profile_entry(const char *name,
+		size_t len) {
+	struct config_profile_entry *entry =
+		calloc(1, sizeof(struct config_profile_entry));
+	if (!entry) {
+		return NULL;
+	}
+	entry->name = strndup(name, len);
+	return entry;
+}
+
+static void profile_add_command(struct config_profile *profile,
+		const char *line, uint64_t nsec) {
+	size_t len = strcspn(line, " \t");
+	struct config_profile_entry *entry =
+		hash_table_get(profile->commands, line, len);
+	if (!entry) {
+		entry = create_profile_entry(line, len);
+		if (!entry) {
+			return;
+		}
+		hash_table_set(profile->commands, entry->name, len, entry);
+	}
+	entry->count++;
+	entry->nsec += nsec;
+}
+
+static void collect_profile_command(const void *key, size_t key_len,
+		void *value, void *data) {
+	list_add(data, value);
+}
+
+static int cmp_profile_entry(const void *_a, const void *_b) {
+	const struct config_profile_entry *a = *(void **)_a;
+	const struct config_profile_entry *b = *(void **)_b;
+	return a->nsec < b->nsec ? 1 : a->nsec > b->nsec ? -1 : 0;
+}
+
+void print_config_profile(struct sway_config *config) {
+	struct config_profile *profile = config->profile;
+	if (!profile) {
+		return;
+	}
+	list_t *commands = create_list();
+	hash_table_foreach(profile->commands, collect_profile_command, commands);
+	list_qsort(commands, cmp_profile_entry);
+	printf("%-32s %8s %12s %12s\n", "command", "count", "total (ms)",
+			"mean (us)");
+	for (int i = 0; i < commands->length; ++i) {
+		struct config_profile_entry *entry = commands->items[i];
+		printf("%-32s %8d %12.3f %12.3f\n", entry->name, entry->count,
+				entry->nsec / 1000000.0, entry->nsec / 1000.0 / entry->count);
+	}
+	list_free(commands);
+
+	// Files are timed including the files they include
+	printf("\n%-45s %12s\n", "file", "total (ms)");
+	for (int i = 0; i < profile->files->length; ++i) {
+		struct config_profile_entry *entry = profile->files->items[i];
+		printf("%-45s %12.3f\n", entry->name, entry->nsec / 1000000.0);
+	}
+}
+
 void free_config(struct sway_config *config) {
 	if (!config) {
 		return;
@@ -82,6 +186,8 @@ void free_config(struct sway_config *config) {
 		}
 		list_free(config->symbols);
 	}
+	variable_trie_free(config->symbols_trie);
+	config_profile_destroy(config->profile);
 	if (config->modes) {
 		for (int i = 0; i < config->modes->length; ++i) {
 			free_mode(config->modes->items[i]);
@@ -120,6 +226,7 @@ void free_config(struct sway_config *config) {
 		}
 		list_free(config->criteria);
 	}
+	criteria_index_destroy(config->criteria_index);
 	list_free(config->no_focus);
 	list_free(config->active_bar_modifiers);
 	list_free(config->config_chain);
@@ -153,6 +260,86 @@ static void destroy_removed_seats(struct sway_config *old_config,
 	}
 }
 
+/**
+ * Applies the output, input and seat configs which differ from the previous
+ * config after a reload. Bars which didn't change take over the previous
+ * bar's swaybar instead of being restarted.
+ */
+static void apply_config_changes(struct sway_config *old_config) {
+	for (int i = 0; i < config->output_configs->length; ++i) {
+		struct output_config *oc = config->output_configs->items[i];
+		int j = list_seq_find(old_config->output_configs,
+				output_name_cmp, oc->name);
+		if (j < 0 || !output_config_equal(oc,
+					old_config->output_configs->items[j])) {
+			apply_output_config_to_outputs(oc);
+		}
+	}
+
+	for (int i = 0; i < config->input_configs->length; ++i) {
+		struct input_config *ic = config->input_configs->items[i];
+		int j = list_seq_find(old_config->input_configs,
+				input_identifier_cmp, ic->identifier);
+		if (j < 0 || !input_config_equal(ic,
+					old_config->input_configs->items[j])) {
+			input_manager_apply_input_config(input_manager, ic);
+		}
+	}
+	for (int i = 0; i < old_config->input_configs->length; ++i) {
+		struct input_config *ic = old_config->input_configs->items[i];
+		if (list_seq_find(config->input_configs,
+					input_identifier_cmp, ic->identifier) < 0) {
+			// Reconfigure devices whose config was removed
+			input_manager_apply_input_config(input_manager, ic);
+		}
+	}
+
+	for (int i = 0; i < config->seat_configs->length; ++i) {
+		struct seat_config *sc = config->seat_configs->items[i];
+		int j = list_seq_find(old_config->seat_configs,
+				seat_name_cmp, sc->name);
+		if (j < 0 || !seat_config_equal(sc,
+					old_config->seat_configs->items[j])) {
+			input_manager_apply_seat_config(input_manager, sc);
+		}
+	}
+
+	// Bars without their own font use the global one
+	bool font_changed = lenient_strcmp(old_config->font, config->font) != 0;
+	for (int i = 0; i < config->bars->length; ++i) {
+		struct bar_config *bar = config->bars->items[i];
+		for (int j = 0; j < old_config->bars->length; ++j) {
+			struct bar_config *old_bar = old_config->bars->items[j];
+			if (strcmp(bar->id, old_bar->id) != 0) {
+				continue;
+			}
+			if (old_bar->pid != 0 && (!font_changed || bar->font) &&
+					bar_config_equal(old_bar, bar)) {
+				bar->pid = old_bar->pid;
+				old_bar->pid = 0;
+			}
+			break;
+		}
+	}
+}
+
+/**
+ * Updates titles and marks after a reload if the font or colors changed.
+ */
+static void update_appearance(struct sway_config *old_config) {
+	bool font_changed = lenient_strcmp(old_config->font, config->font) != 0 ||
+		old_config->pango_markup != config->pango_markup;
+	if (font_changed) {
+		config_update_font_height(true);
+	} else {
+		config->font_height = old_config->font_height;
+	}
+	if (font_changed || memcmp(&old_config->border_colors,
+				&config->border_colors, sizeof(config->border_colors)) != 0) {
+		container_update_textures_recursive(&root_container);
+	}
+}
+
 static void set_color(float dest[static 4], uint32_t color) {
 	dest[0] = ((color >> 16) & 0xff) / 255.0;
 	dest[1] = ((color >> 8) & 0xff) / 255.0;
@@ -173,10 +360,13 @@ static void config_defaults(struct sway_config *config) {
 	};
 
 	if (!(config->symbols = create_list())) goto cleanup;
+	if (!(config->symbols_trie =
+			calloc(1, sizeof(struct sway_variable_trie)))) goto cleanup;
 	if (!(config->modes = create_list())) goto cleanup;
 	if (!(config->bars = create_list())) goto cleanup;
 	if (!(config->workspace_outputs = create_list())) goto cleanup;
 	if (!(config->criteria = create_list())) goto cleanup;
+	if (!(config->criteria_index = criteria_index_create())) goto cleanup;
 	if (!(config->no_focus = create_list())) goto cleanup;
 	if (!(config->input_configs = create_list())) goto cleanup;
 	if (!(config->seat_configs = create_list())) goto cleanup;
@@ -184,13 +374,19 @@ static void config_defaults(struct sway_config *config) {
 
 	if (!(config->cmd_queue = create_list())) goto cleanup;
 
-	if (!(config->current_mode = malloc(sizeof(struct sway_mode))))
+	if (!(config->current_mode = calloc(1, sizeof(struct sway_mode))))
 		goto cleanup;
 	if (!(config->current_mode->name = malloc(sizeof("default")))) goto cleanup;
 	strcpy(config->current_mode->name, "default");
 	if (!(config->current_mode->keysym_bindings = create_list())) goto cleanup;
 	if (!(config->current_mode->keycode_bindings = create_list())) goto cleanup;
 	if (!(config->current_mode->mouse_bindings = create_list())) goto cleanup;
+	if (!(config->current_mode->keysym_index = create_hash_table())) {
+		goto cleanup;
+	}
+	if (!(config->current_mode->keycode_index = create_hash_table())) {
+		goto cleanup;
+	}
 	list_add(config->modes, config->current_mode);
 
 	config->floating_mod = 0;
@@ -354,9 +550,23 @@ static bool load_config(const char *path, struct sway_config *config,
 		return false;
 	}
 
+	struct config_profile_entry *profile_entry = NULL;
+	if (config->profile) {
+		profile_entry = create_profile_entry(path, strlen(path));
+		if (profile_entry) {
+			list_add(config->profile->files, profile_entry);
+		}
+	}
+	uint64_t start = get_time_nsec();
+
 	bool config_load_success = read_config(f, config, swaynag);
 	fclose(f);
 
+	if (profile_entry) {
+		profile_entry->count = 1;
+		profile_entry->nsec = get_time_nsec() - start;
+	}
+
 	if (!config_load_success) {
 		wlr_log(WLR_ERROR, "Error(s) loading config!");
 	}
@@ -364,7 +574,8 @@ static bool load_config(const char *path, struct sway_config *config,
 	return true;
 }
 
-bool load_main_config(const char *file, bool is_active, bool validating) {
+bool load_main_config(const char *file, bool is_active, bool validating,
+		bool profiling) {
 	char *path;
 	if (file != NULL) {
 		path = strdup(file);
@@ -380,6 +591,9 @@ bool load_main_config(const char *file, bool is_active, bool validating) {
 
 	config_defaults(config);
 	config->validating = validating;
+	if (profiling) {
+		config->profile = config_profile_create();
+	}
 	if (is_active) {
 		wlr_log(WLR_DEBUG, "Performing configuration file reload");
 		config->reloading = true;
@@ -450,10 +664,9 @@ bool load_main_config(const char *file, bool is_active, bool validating) {
 			&config->swaynag_config_errors);
 
 	if (is_active) {
-		for (int i = 0; i < config->output_configs->length; i++) {
-			apply_output_config_to_outputs(config->output_configs->items[i]);
-		}
+		apply_config_changes(old_config);
 		config->reloading = false;
+		update_appearance(old_config);
 		if (config->swaynag_config_errors.pid > 0) {
 			swaynag_show(&config->swaynag_config_errors);
 		}
@@ -563,31 +776,149 @@ bool load_include_configs(const char *path, struct sway_config *config,
 	return true;
 }
 
-static int detect_brace_on_following_line(FILE *file, char *line,
-		int line_number) {
-	int lines = 0;
-	if (line[strlen(line) - 1] != '{' && line[strlen(line) - 1] != '}') {
-		char *peeked = NULL;
-		long position = 0;
-		do {
-			wlr_log(WLR_DEBUG, "Peeking line %d", line_number + lines + 1);
-			free(peeked);
-			peeked = peek_line(file, lines, &position);
-			if (peeked) {
-				peeked = strip_whitespace(peeked);
+/**
+ * A config file read into memory in one go, so that looking ahead for a brace
+ * on the following line doesn't need to seek.
+ */
+struct config_reader {
+	char *data;
+	size_t len;
+	size_t pos;
+};
+
+static bool config_reader_init(struct config_reader *reader, FILE *file) {
+	int ret_seek = fseek(file, 0, SEEK_END);
+	long ret_tell = ftell(file);
+	if (ret_seek == -1 || ret_tell == -1) {
+		wlr_log(WLR_ERROR, "Unable to get size of config file");
+		return false;
+	}
+	rewind(file);
+
+	reader->data = malloc(ret_tell + 1);
+	if (!reader->data) {
+		wlr_log(WLR_ERROR, "Unable to allocate buffer for config contents");
+		return false;
+	}
+	reader->len = fread(reader->data, 1, ret_tell, file);
+	reader->data[reader->len] = '\0';
+	reader->pos = 0;
+	return true;
+}
+
+static bool is_line_space(char c) {
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+/**
+ * Returns the next line with line continuations joined and surrounding
+ * whitespace stripped, or NULL at the end of the file. If raw_len is given, it
+ * is set to the length of the line before stripping, which is where raw is
+ * copied.
+ */
+static char *config_reader_next_line(struct config_reader *reader,
+		char *raw, size_t *raw_len) {
+	if (reader->pos >= reader->len) {
+		return NULL;
+	}
+	const char *data = reader->data;
+	size_t pos = reader->pos;
+	const char *eol = memchr(data + pos, '\n', reader->len - pos);
+	size_t max_len = (eol ? (size_t)(eol - data) : reader->len) - pos;
+	size_t size = max_len + 1, length = 0;
+	char *line = malloc(size);
+	if (!line) {
+		wlr_log(WLR_ERROR, "Unable to allocate memory for config line");
+		reader->pos = reader->len;
+		return NULL;
+	}
+	char last = '\0';
+	for (; pos < reader->len; ++pos) {
+		char c = data[pos];
+		if (c == '\n' && last == '\\') {
+			// Ignore the backslash and join the next line
+			--length;
+			last = '\0';
+			continue;
+		}
+		if (c == '\n' || c == '\0') {
+			++pos;
+			break;
+		}
+		if (c == '\r') {
+			continue;
+		}
+		if (length + 1 == size) {
+			char *new_line = realloc(line, size *= 2);
+			if (!new_line) {
+				free(line);
+				wlr_log(WLR_ERROR, "Unable to allocate memory for config line");
+				reader->pos = reader->len;
+				return NULL;
 			}
-			wlr_log(WLR_DEBUG, "Peeked line: `%s`", peeked);
-			lines++;
-		} while (peeked && strlen(peeked) == 0);
+			line = new_line;
+		}
+		line[length++] = c;
+		last = c;
+	}
+	line[length] = '\0';
+	reader->pos = pos;
 
-		if (peeked && strlen(peeked) == 1 && peeked[0] == '{') {
-			fseek(file, position, SEEK_SET);
-		} else {
-			lines = 0;
+	if (raw) {
+		memcpy(raw, line, length + 1);
+	}
+	if (raw_len) {
+		*raw_len = length;
+	}
+
+	size_t start = 0;
+	while (start < length && is_line_space(line[start])) {
+		++start;
+	}
+	while (length > start && is_line_space(line[length - 1])) {
+		--length;
+	}
+	memmove(line, line + start, length - start);
+	line[length - start] = '\0';
+	return line;
+}
+
+/**
+ * Checks whether the line is followed by a line containing only an opening
+ * brace, skipping any blank lines. If so, the reader is moved past the brace
+ * and the number of lines skipped is returned.
+ */
+static int detect_brace_on_following_line(struct config_reader *reader,
+		const char *line) {
+	size_t line_len = strlen(line);
+	if (line[line_len - 1] == '{' || line[line_len - 1] == '}') {
+		return 0;
+	}
+	int lines = 0;
+	size_t pos = reader->pos;
+	while (pos < reader->len) {
+		const char *start = reader->data + pos;
+		const char *eol = memchr(start, '\n', reader->len - pos);
+		const char *end = eol ? eol : reader->data + reader->len;
+		pos = end - reader->data + (eol ? 1 : 0);
+		++lines;
+
+		while (start < end && is_line_space(*start)) {
+			++start;
 		}
-		free(peeked);
+		while (end > start && is_line_space(end[-1])) {
+			--end;
+		}
+		if (start == end) {
+			continue;
+		}
+		if (end - start == 1 && *start == '{') {
+			reader->pos = pos;
+			return lines;
+		}
+		break;
 	}
-	return lines;
+	return 0;
 }
 
 static char *expand_line(const char *block, const char *line, bool add_brace) {
@@ -605,24 +936,20 @@ static char *expand_line(const char *block, const char *line, bool add_brace) {
 
 bool read_config(FILE *file, struct sway_config *config,
 		struct swaynag_instance *swaynag) {
+	struct config_reader reader;
+	if (!config_reader_init(&reader, file)) {
+		return false;
+	}
+
 	bool reading_main_config = false;
 	char *this_config = NULL;
-	size_t config_size = 0;
 	if (config->current_config == NULL) {
 		reading_main_config = true;
 
-		int ret_seek = fseek(file, 0, SEEK_END);
-		long ret_tell = ftell(file);
-		if (ret_seek == -1 || ret_tell == -1) {
-			wlr_log(WLR_ERROR, "Unable to get size of config file");
-			return false;
-		}
-		config_size = ret_tell;
-		rewind(file);
-
-		config->current_config = this_config = calloc(1, config_size + 1);
+		config->current_config = this_config = calloc(1, reader.len + 1);
 		if (this_config == NULL) {
 			wlr_log(WLR_ERROR, "Unable to allocate buffer for config contents");
+			free(reader.data);
 			return false;
 		}
 	}
@@ -632,34 +959,25 @@ bool read_config(FILE *file, struct sway_config *config,
 	char *line;
 	list_t *stack = create_list();
 	size_t read = 0;
-	while (!feof(file)) {
+	while (true) {
 		char *block = stack->length ? stack->items[0] : NULL;
-		line = read_line(file);
+		size_t length = 0;
+		line = config_reader_next_line(&reader,
+				reading_main_config ? this_config + read : NULL, &length);
 		if (!line) {
-			continue;
+			break;
 		}
 		line_number++;
 		wlr_log(WLR_DEBUG, "Read line %d: %s", line_number, line);
 
 		if (reading_main_config) {
-			size_t length = strlen(line);
-
-			if (read + length > config_size) {
-				wlr_log(WLR_ERROR, "Config file changed during reading");
-				list_foreach(stack, free);
-				list_free(stack);
-				free(line);
-				return false;
-			}
-
-			strcpy(this_config + read, line);
+			// Lines are copied to the config contents joined by newlines
 			if (line_number != 1) {
 				this_config[read - 1] = '\n';
 			}
 			read += length + 1;
 		}
 
-		line = strip_whitespace(line);
 		if (line[0] == '#') {
 			free(line);
 			continue;
@@ -668,8 +986,7 @@ bool read_config(FILE *file, struct sway_config *config,
 			free(line);
 			continue;
 		}
-		int brace_detected = detect_brace_on_following_line(file, line,
-				line_number);
+		int brace_detected = detect_brace_on_following_line(&reader, line);
 		if (brace_detected > 0) {
 			line_number += brace_detected;
 			wlr_log(WLR_DEBUG, "Detected open brace on line %d", line_number);
@@ -679,9 +996,11 @@ bool read_config(FILE *file, struct sway_config *config,
 			list_foreach(stack, free);
 			list_free(stack);
 			free(line);
+			free(reader.data);
 			return false;
 		}
 		wlr_log(WLR_DEBUG, "Expanded line: %s", expanded);
+		uint64_t start = config->profile ? get_time_nsec() : 0;
 		struct cmd_results *res;
 		if (block && strcmp(block, "<commands>") == 0) {
 			// Special case
@@ -689,6 +1008,10 @@ bool read_config(FILE *file, struct sway_config *config,
 		} else {
 			res = config_command(expanded);
 		}
+		if (config->profile) {
+			profile_add_command(config->profile, expanded,
+					get_time_nsec() - start);
+		}
 		switch(res->status) {
 		case CMD_FAILURE:
 		case CMD_INVALID:
@@ -743,59 +1066,141 @@ bool read_config(FILE *file, struct sway_config *config,
 	}
 	list_foreach(stack, free);
 	list_free(stack);
+	free(reader.data);
 
 	return success;
 }
 
+bool variable_trie_add(struct sway_variable_trie *trie,
+		struct sway_variable *var) {
+	for (const char *c = var->name; *c; ++c) {
+		struct sway_variable_trie *child = trie->child;
+		while (child && child->c != *c) {
+			child = child->next;
+		}
+		if (!child) {
+			child = calloc(1, sizeof(struct sway_variable_trie));
+			if (!child) {
+				return false;
+			}
+			child->c = *c;
+			child->next = trie->child;
+			trie->child = child;
+		}
+		trie = child;
+	}
+	trie->var = var;
+	return true;
+}
+
+void variable_trie_free(struct sway_variable_trie *trie) {
+	while (trie) {
+		struct sway_variable_trie *next = trie->next;
+		variable_trie_free(trie->child);
+		free(trie);
+		trie = next;
+	}
+}
+
+/**
+ * Returns the variable with the longest name which is a prefix of str.
+ */
+static struct sway_variable *variable_trie_match(
+		struct sway_variable_trie *trie, const char *str) {
+	struct sway_variable *match = NULL;
+	for (const char *c = str; *c && trie; ++c) {
+		trie = trie->child;
+		while (trie && trie->c != *c) {
+			trie = trie->next;
+		}
+		if (trie && trie->var) {
+			match = trie->var;
+		}
+	}
+	return match;
+}
+
+struct var_buffer {
+	char *data;
+	size_t len, size;
+};
+
+static bool var_buffer_append(struct var_buffer *buf, const char *str,
+		size_t len) {
+	if (buf->len + len + 1 > buf->size) {
+		size_t size = buf->size * 2;
+		while (buf->len + len + 1 > size) {
+			size *= 2;
+		}
+		char *data = realloc(buf->data, size);
+		if (!data) {
+			return false;
+		}
+		buf->data = data;
+		buf->size = size;
+	}
+	memcpy(buf->data + buf->len, str, len);
+	buf->len += len;
+	buf->data[buf->len] = '\0';
+	return true;
+}
+
 char *do_var_replacement(char *str) {
-	int i;
-	char *find = str;
-	while ((find = strchr(find, '$'))) {
-		// Skip if escaped.
-		if (find > str && find[-1] == '\\') {
-			if (find == str + 1 || !(find > str + 1 && find[-2] == '\\')) {
-				++find;
-				continue;
+	if (!strchr(str, '$')) {
+		return str;
+	}
+	struct var_buffer buf = { .size = strlen(str) + 1 };
+	buf.data = malloc(buf.size);
+	if (!buf.data) {
+		goto error;
+	}
+	const char *head = str;
+	const char *find;
+	while ((find = strchr(head, '$'))) {
+		if (!var_buffer_append(&buf, head, find - head)) {
+			goto error;
+		}
+		// Skip if escaped. This looks at the output, as substituted values
+		// can end in a backslash.
+		if (buf.len > 0 && buf.data[buf.len - 1] == '\\' &&
+				(buf.len == 1 || buf.data[buf.len - 2] != '\\')) {
+			if (!var_buffer_append(&buf, "$", 1)) {
+				goto error;
 			}
+			head = find + 1;
+			continue;
 		}
 		// Unescape double $ and move on
 		if (find[1] == '$') {
-			size_t length = strlen(find + 1);
-			memmove(find, find + 1, length);
-			find[length] = '\0';
-			++find;
+			if (!var_buffer_append(&buf, "$", 1)) {
+				goto error;
+			}
+			head = find + 2;
 			continue;
 		}
-		// Find matching variable
-		for (i = 0; i < config->symbols->length; ++i) {
-			struct sway_variable *var = config->symbols->items[i];
-			int vnlen = strlen(var->name);
-			if (strncmp(find, var->name, vnlen) == 0) {
-				int vvlen = strlen(var->value);
-				char *newstr = malloc(strlen(str) - vnlen + vvlen + 1);
-				if (!newstr) {
-					wlr_log(WLR_ERROR,
-						"Unable to allocate replacement "
-						"during variable expansion");
-					break;
-				}
-				char *newptr = newstr;
-				int offset = find - str;
-				strncpy(newptr, str, offset);
-				newptr += offset;
-				strncpy(newptr, var->value, vvlen);
-				newptr += vvlen;
-				strcpy(newptr, find + vnlen);
-				free(str);
-				str = newstr;
-				find = str + offset + vvlen;
-				break;
+		struct sway_variable *var =
+			variable_trie_match(config->symbols_trie, find);
+		if (var) {
+			if (!var_buffer_append(&buf, var->value, strlen(var->value))) {
+				goto error;
 			}
-		}
-		if (i == config->symbols->length) {
-			++find;
+			head = find + strlen(var->name);
+		} else {
+			if (!var_buffer_append(&buf, "$", 1)) {
+				goto error;
+			}
+			head = find + 1;
 		}
 	}
+	if (!var_buffer_append(&buf, head, strlen(head))) {
+		goto error;
+	}
+	free(str);
+	return buf.data;
+
+error:
+	wlr_log(WLR_ERROR, "Unable to allocate replacement during variable expansion");
+	free(buf.data);
 	return str;
 }
 
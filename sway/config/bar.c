@@ -12,6 +12,7 @@
 #include <strings.h>
 #include <signal.h>
 #include "sway/config.h"
+#include "sway/ipc-json.h"
 #include "stringop.h"
 #include "list.h"
 #include "log.h"
@@ -229,22 +230,23 @@ static bool active_output(const char *name) {
 	return false;
 }
 
+static bool bar_on_active_output(struct bar_config *bar) {
+	if (!bar->outputs) {
+		return true;
+	}
+	for (int i = 0; i < bar->outputs->length; ++i) {
+		char *o = bar->outputs->items[i];
+		if (!strcmp(o, "*") || active_output(o)) {
+			return true;
+		}
+	}
+	return false;
+}
+
 void load_swaybars() {
 	for (int i = 0; i < config->bars->length; ++i) {
 		struct bar_config *bar = config->bars->items[i];
-		bool apply = false;
-		if (bar->outputs) {
-			for (int j = 0; j < bar->outputs->length; ++j) {
-				char *o = bar->outputs->items[j];
-				if (!strcmp(o, "*") || active_output(o)) {
-					apply = true;
-					break;
-				}
-			}
-		} else {
-			apply = true;
-		}
-		if (apply) {
+		if (bar_on_active_output(bar)) {
 			if (bar->pid != 0) {
 				terminate_swaybar(bar->pid);
 			}
@@ -253,3 +255,27 @@ void load_swaybars() {
 		}
 	}
 }
+
+void load_new_swaybars(void) {
+	for (int i = 0; i < config->bars->length; ++i) {
+		struct bar_config *bar = config->bars->items[i];
+		if (bar->pid == 0 && bar_on_active_output(bar)) {
+			wlr_log(WLR_DEBUG, "Invoking swaybar for bar id '%s'", bar->id);
+			invoke_swaybar(bar);
+		}
+	}
+}
+
+bool bar_config_equal(struct bar_config *a, struct bar_config *b) {
+	if (lenient_strcmp(a->swaybar_command, b->swaybar_command) != 0) {
+		return false;
+	}
+	// The IPC description covers everything swaybar gets from its config
+	json_object *json_a = ipc_json_describe_bar_config(a);
+	json_object *json_b = ipc_json_describe_bar_config(b);
+	bool equal = strcmp(json_object_to_json_string(json_a),
+			json_object_to_json_string(json_b)) == 0;
+	json_object_put(json_a);
+	json_object_put(json_b);
+	return equal;
+}
@@ -3,6 +3,7 @@
 #include <limits.h>
 #include <float.h>
 #include "sway/config.h"
+#include "stringop.h"
 #include "log.h"
 
 struct input_config *new_input_config(const char* identifier) {
@@ -143,6 +144,45 @@ void free_input_config(struct input_config *ic) {
 	free(ic);
 }
 
+static bool mapped_from_region_equal(
+		struct input_config_mapped_from_region *a,
+		struct input_config_mapped_from_region *b) {
+	if (!a || !b) {
+		return a == b;
+	}
+	return a->x1 == b->x1 && a->y1 == b->y1 &&
+		a->x2 == b->x2 && a->y2 == b->y2 && a->mm == b->mm;
+}
+
+bool input_config_equal(struct input_config *a, struct input_config *b) {
+	return strcmp(a->identifier, b->identifier) == 0 &&
+		a->accel_profile == b->accel_profile &&
+		a->click_method == b->click_method &&
+		a->drag_lock == b->drag_lock &&
+		a->dwt == b->dwt &&
+		a->left_handed == b->left_handed &&
+		a->middle_emulation == b->middle_emulation &&
+		a->natural_scroll == b->natural_scroll &&
+		a->pointer_accel == b->pointer_accel &&
+		a->repeat_delay == b->repeat_delay &&
+		a->repeat_rate == b->repeat_rate &&
+		a->scroll_button == b->scroll_button &&
+		a->scroll_method == b->scroll_method &&
+		a->send_events == b->send_events &&
+		a->tap == b->tap &&
+		a->tap_button_map == b->tap_button_map &&
+		lenient_strcmp(a->xkb_layout, b->xkb_layout) == 0 &&
+		lenient_strcmp(a->xkb_model, b->xkb_model) == 0 &&
+		lenient_strcmp(a->xkb_options, b->xkb_options) == 0 &&
+		lenient_strcmp(a->xkb_rules, b->xkb_rules) == 0 &&
+		lenient_strcmp(a->xkb_variant, b->xkb_variant) == 0 &&
+		a->xkb_numlock == b->xkb_numlock &&
+		a->xkb_capslock == b->xkb_capslock &&
+		mapped_from_region_equal(a->mapped_from_region,
+			b->mapped_from_region) &&
+		lenient_strcmp(a->mapped_to_output, b->mapped_to_output) == 0;
+}
+
 int input_identifier_cmp(const void *item, const void *data) {
 	const struct input_config *ic = item;
 	const char *identifier = data;
@@ -10,6 +10,7 @@
 #include "sway/config.h"
 #include "sway/output.h"
 #include "sway/tree/root.h"
+#include "stringop.h"
 #include "log.h"
 
 int output_name_cmp(const void *item, const void *data) {
@@ -323,6 +324,20 @@ void apply_output_config_to_outputs(struct output_config *oc) {
 	}
 }
 
+bool output_config_equal(struct output_config *a, struct output_config *b) {
+	return strcmp(a->name, b->name) == 0 &&
+		a->enabled == b->enabled &&
+		a->width == b->width && a->height == b->height &&
+		a->refresh_rate == b->refresh_rate &&
+		a->x == b->x && a->y == b->y &&
+		a->scale == b->scale &&
+		a->transform == b->transform &&
+		lenient_strcmp(a->background, b->background) == 0 &&
+		lenient_strcmp(a->background_option, b->background_option) == 0 &&
+		lenient_strcmp(a->background_fallback, b->background_fallback) == 0 &&
+		a->dpms_state == b->dpms_state;
+}
+
 void free_output_config(struct output_config *oc) {
 	if (!oc) {
 		return;
@@ -74,6 +74,15 @@ void merge_seat_config(struct seat_config *dest, struct seat_config *source) {
 		dest->fallback = source->fallback;
 	}
 
+	if (source->motion_coalescing != MOTION_COALESCING_DEFAULT) {
+		dest->motion_coalescing = source->motion_coalescing;
+		dest->motion_rate = source->motion_rate;
+	}
+
+	if (source->pointer_constraint != POINTER_CONSTRAINT_DEFAULT) {
+		dest->pointer_constraint = source->pointer_constraint;
+	}
+
 	for (int i = 0; i < source->attachments->length; ++i) {
 		struct seat_attachment_config *source_attachment =
 			source->attachments->items[i];
@@ -132,6 +141,23 @@ int seat_name_cmp(const void *item, const void *data) {
 	return strcmp(sc->name, name);
 }
 
+bool seat_config_equal(struct seat_config *a, struct seat_config *b) {
+	if (strcmp(a->name, b->name) != 0 || a->fallback != b->fallback ||
+			a->motion_coalescing != b->motion_coalescing ||
+			a->motion_rate != b->motion_rate ||
+			a->pointer_constraint != b->pointer_constraint ||
+			a->attachments->length != b->attachments->length) {
+		return false;
+	}
+	for (int i = 0; i < a->attachments->length; ++i) {
+		struct seat_attachment_config *attachment = a->attachments->items[i];
+		if (!seat_config_get_attachment(b, attachment->identifier)) {
+			return false;
+		}
+	}
+	return true;
+}
+
 struct seat_attachment_config *seat_config_get_attachment(
 		struct seat_config *seat_config, char *identifier) {
 	for (int i = 0; i < seat_config->attachments->length; ++i) {
@@ -2,12 +2,16 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
 #include <pcre.h>
+#include "sway/commands.h"
 #include "sway/criteria.h"
 #include "sway/tree/container.h"
 #include "sway/config.h"
 #include "sway/tree/root.h"
 #include "sway/tree/view.h"
+#include "sway/tree/workspace.h"
 #include "stringop.h"
 #include "list.h"
 #include "log.h"
@@ -32,22 +36,49 @@ bool criteria_is_empty(struct criteria *criteria) {
 		&& !criteria->workspace;
 }
 
+static void pattern_destroy(struct pattern *pattern) {
+	if (!pattern) {
+		return;
+	}
+	if (pattern->regex_extra) {
+		pcre_free_study(pattern->regex_extra);
+	}
+	pcre_free(pattern->regex);
+	free(pattern->literal);
+	free(pattern);
+}
+
 void criteria_destroy(struct criteria *criteria) {
-	pcre_free(criteria->title);
-	pcre_free(criteria->shell);
-	pcre_free(criteria->app_id);
-	pcre_free(criteria->class);
-	pcre_free(criteria->instance);
-	pcre_free(criteria->con_mark);
-	pcre_free(criteria->window_role);
+	pattern_destroy(criteria->title);
+	pattern_destroy(criteria->shell);
+	pattern_destroy(criteria->app_id);
+	pattern_destroy(criteria->class);
+	pattern_destroy(criteria->instance);
+	pattern_destroy(criteria->con_mark);
+	pattern_destroy(criteria->window_role);
 	free(criteria->workspace);
 	free(criteria->cmdlist);
+	free_compiled_command(criteria->compiled_cmdlist);
 	free(criteria->raw);
 	free(criteria);
 }
 
-static int regex_cmp(const char *item, const pcre *regex) {
-	return pcre_exec(regex, NULL, item, strlen(item), 0, 0, NULL, 0);
+static bool pattern_matches(const char *item, const struct pattern *pattern) {
+	size_t len = pattern->literal_len;
+	switch (pattern->match_type) {
+	case PATTERN_CONTAINS:
+		return strstr(item, pattern->literal) != NULL;
+	case PATTERN_PREFIX:
+		return strncmp(item, pattern->literal, len) == 0;
+	case PATTERN_EXACT:
+		// Like PCRE's $, allow a single trailing newline
+		return strncmp(item, pattern->literal, len) == 0 &&
+			(item[len] == '\0' || (item[len] == '\n' && item[len + 1] == '\0'));
+	case PATTERN_PCRE:
+		break;
+	}
+	return pcre_exec(pattern->regex, pattern->regex_extra,
+			item, strlen(item), 0, 0, NULL, 0) >= 0;
 }
 
 static int cmp_urgent(const void *_a, const void *_b) {
@@ -75,39 +106,58 @@ static void find_urgent_iterator(struct sway_container *swayc, void *data) {
 	list_add(urgent_views, swayc->sway_view);
 }
 
+/**
+ * Returns the oldest ('o') or latest ('l') urgent view.
+ */
+static struct sway_view *find_urgent_view(char urgent) {
+	list_t *urgent_views = create_list();
+	root_for_each_container(find_urgent_iterator, urgent_views);
+	struct sway_view *target = NULL;
+	if (urgent_views->length) {
+		list_stable_sort(urgent_views, cmp_urgent);
+		if (urgent == 'o') { // oldest
+			target = urgent_views->items[0];
+		} else { // latest
+			target = urgent_views->items[urgent_views->length - 1];
+		}
+	}
+	list_free(urgent_views);
+	return target;
+}
+
 static bool criteria_matches_view(struct criteria *criteria,
 		struct sway_view *view) {
 	if (criteria->title) {
 		const char *title = view_get_title(view);
-		if (!title || regex_cmp(title, criteria->title) != 0) {
+		if (!title || !pattern_matches(title, criteria->title)) {
 			return false;
 		}
 	}
 
 	if (criteria->shell) {
 		const char *shell = view_get_shell(view);
-		if (!shell || regex_cmp(shell, criteria->shell) != 0) {
+		if (!shell || !pattern_matches(shell, criteria->shell)) {
 			return false;
 		}
 	}
 
 	if (criteria->app_id) {
 		const char *app_id = view_get_app_id(view);
-		if (!app_id || regex_cmp(app_id, criteria->app_id) != 0) {
+		if (!app_id || !pattern_matches(app_id, criteria->app_id)) {
 			return false;
 		}
 	}
 
 	if (criteria->class) {
 		const char *class = view_get_class(view);
-		if (!class || regex_cmp(class, criteria->class) != 0) {
+		if (!class || !pattern_matches(class, criteria->class)) {
 			return false;
 		}
 	}
 
 	if (criteria->instance) {
 		const char *instance = view_get_instance(view);
-		if (!instance || regex_cmp(instance, criteria->instance) != 0) {
+		if (!instance || !pattern_matches(instance, criteria->instance)) {
 			return false;
 		}
 	}
@@ -115,7 +165,7 @@ static bool criteria_matches_view(struct criteria *criteria,
 	if (criteria->con_mark) {
 		bool exists = false;
 		for (int i = 0; i < view->marks->length; ++i) {
-			if (regex_cmp(view->marks->items[i], criteria->con_mark) == 0) {
+			if (pattern_matches(view->marks->items[i], criteria->con_mark)) {
 				exists = true;
 				break;
 			}
@@ -167,17 +217,7 @@ static bool criteria_matches_view(struct criteria *criteria,
 		if (!view_is_urgent(view)) {
 			return false;
 		}
-		list_t *urgent_views = create_list();
-		root_for_each_container(find_urgent_iterator, urgent_views);
-		list_stable_sort(urgent_views, cmp_urgent);
-		struct sway_view *target;
-		if (criteria->urgent == 'o') { // oldest
-			target = urgent_views->items[0];
-		} else { // latest
-			target = urgent_views->items[urgent_views->length - 1];
-		}
-		list_free(urgent_views);
-		if (view != target) {
+		if (view != find_urgent_view(criteria->urgent)) {
 			return false;
 		}
 	}
@@ -195,18 +235,140 @@ static bool criteria_matches_view(struct criteria *criteria,
 	return true;
 }
 
-list_t *criteria_for_view(struct sway_view *view, enum criteria_type types) {
-	list_t *criterias = config->criteria;
-	list_t *matches = create_list();
-	for (int i = 0; i < criterias->length; ++i) {
-		struct criteria *criteria = criterias->items[i];
-		if ((criteria->type & types) && criteria_matches_view(criteria, view)) {
+struct criteria_index *criteria_index_create(void) {
+	struct criteria_index *index = calloc(1, sizeof(struct criteria_index));
+	if (!index) {
+		return NULL;
+	}
+	index->by_app_id = create_hash_table();
+	index->by_class = create_hash_table();
+	index->by_instance = create_hash_table();
+	index->by_shell = create_hash_table();
+	index->residual = create_list();
+	if (!index->by_app_id || !index->by_class || !index->by_instance ||
+			!index->by_shell || !index->residual) {
+		criteria_index_destroy(index);
+		return NULL;
+	}
+	return index;
+}
+
+static void free_index_bucket(const void *key, size_t key_len, void *value,
+		void *data) {
+	list_free(value);
+}
+
+static void index_table_destroy(hash_table_t *table) {
+	hash_table_foreach(table, free_index_bucket, NULL);
+	hash_table_free(table);
+}
+
+void criteria_index_destroy(struct criteria_index *index) {
+	if (!index) {
+		return;
+	}
+	index_table_destroy(index->by_app_id);
+	index_table_destroy(index->by_class);
+	index_table_destroy(index->by_instance);
+	index_table_destroy(index->by_shell);
+	list_free(index->residual);
+	free(index);
+}
+
+static bool index_table_add(hash_table_t *table, struct pattern *pattern,
+		struct criteria *criteria) {
+	if (!pattern || pattern->match_type != PATTERN_EXACT) {
+		return false;
+	}
+	list_t *bucket =
+		hash_table_get(table, pattern->literal, pattern->literal_len);
+	if (!bucket) {
+		bucket = create_list();
+		if (!hash_table_set(table, pattern->literal, pattern->literal_len,
+					bucket)) {
+			list_free(bucket);
+			return false;
+		}
+	}
+	list_add(bucket, criteria);
+	return true;
+}
+
+void criteria_add(struct criteria *criteria) {
+	criteria->index = config->criteria->length;
+	list_add(config->criteria, criteria);
+
+	struct criteria_index *index = config->criteria_index;
+	if (!index_table_add(index->by_app_id, criteria->app_id, criteria) &&
+			!index_table_add(index->by_class, criteria->class, criteria) &&
+			!index_table_add(index->by_instance, criteria->instance, criteria) &&
+			!index_table_add(index->by_shell, criteria->shell, criteria)) {
+		list_add(index->residual, criteria);
+	}
+}
+
+static void add_matching_criteria(list_t *candidates, struct sway_view *view,
+		enum criteria_type types, uint32_t changed, list_t *matches) {
+	if (!candidates) {
+		return;
+	}
+	for (int i = 0; i < candidates->length; ++i) {
+		struct criteria *criteria = candidates->items[i];
+		if ((criteria->type & types) && (criteria->depends & changed) &&
+				criteria_matches_view(criteria, view)) {
 			list_add(matches, criteria);
 		}
 	}
+}
+
+static void add_indexed_criteria(hash_table_t *table, const char *value,
+		struct sway_view *view, enum criteria_type types, uint32_t changed,
+		list_t *matches) {
+	if (!value) {
+		return;
+	}
+	size_t len = strlen(value);
+	add_matching_criteria(hash_table_get(table, value, len),
+			view, types, changed, matches);
+	// Exact patterns also accept a single trailing newline, like PCRE's $
+	if (len && value[len - 1] == '\n') {
+		add_matching_criteria(hash_table_get(table, value, len - 1),
+				view, types, changed, matches);
+	}
+}
+
+static int cmp_criteria_index(const void *_a, const void *_b) {
+	const struct criteria *a = *(void **)_a;
+	const struct criteria *b = *(void **)_b;
+	return a->index - b->index;
+}
+
+list_t *criteria_for_view_changed(struct sway_view *view,
+		enum criteria_type types, uint32_t changed) {
+	struct criteria_index *index = config->criteria_index;
+	list_t *matches = create_list();
+	if (changed & ~VIEW_MASK_UNTRACKED) {
+		changed |= VIEW_MASK_UNTRACKED;
+	}
+	add_indexed_criteria(index->by_app_id, view_get_app_id(view),
+			view, types, changed, matches);
+	add_indexed_criteria(index->by_class, view_get_class(view),
+			view, types, changed, matches);
+	add_indexed_criteria(index->by_instance, view_get_instance(view),
+			view, types, changed, matches);
+	add_indexed_criteria(index->by_shell, view_get_shell(view),
+			view, types, changed, matches);
+	add_matching_criteria(index->residual, view, types, changed, matches);
+	// Each criteria is in exactly one bucket, so there are no duplicates, but
+	// callers expect the matches in config order
+	list_qsort(matches, cmp_criteria_index);
 	return matches;
 }
 
+list_t *criteria_for_view(struct sway_view *view, enum criteria_type types) {
+	return criteria_for_view_changed(view, types, VIEW_MASK_ALL);
+}
+
 struct match_data {
 	struct criteria *criteria;
 	list_t *matches;
@@ -222,13 +384,54 @@ static void criteria_get_views_iterator(struct sway_container *container,
 	}
 }
 
+static struct sway_container *find_workspace_by_exact_name(const char *name) {
+	for (int i = 0; i < root_container.children->length; ++i) {
+		struct sway_container *output = root_container.children->items[i];
+		for (int j = 0; j < output->children->length; ++j) {
+			struct sway_container *ws = output->children->items[j];
+			if (strcmp(ws->name, name) == 0) {
+				return ws;
+			}
+		}
+	}
+	return NULL;
+}
+
 list_t *criteria_get_views(struct criteria *criteria) {
 	list_t *matches = create_list();
 	struct match_data data = {
 		.criteria = criteria,
 		.matches = matches,
 	};
-	root_for_each_container(criteria_get_views_iterator, &data);
+	// Fields which pin the criteria to a single container or workspace
+	// narrow down which part of the tree needs to be searched
+	if (criteria->con_id) {
+		struct sway_container *con =
+			root_find_container_by_id(criteria->con_id);
+		if (con) {
+			criteria_get_views_iterator(con, &data);
+		}
+	} else if (criteria->con_mark
+			&& criteria->con_mark->match_type == PATTERN_EXACT) {
+		struct sway_view *view =
+			view_find_mark(criteria->con_mark->literal);
+		if (view) {
+			criteria_get_views_iterator(view->swayc, &data);
+		}
+	} else if (criteria->urgent) {
+		struct sway_view *view = find_urgent_view(criteria->urgent);
+		if (view && view->swayc) {
+			criteria_get_views_iterator(view->swayc, &data);
+		}
+	} else if (criteria->workspace) {
+		struct sway_container *ws =
+			find_workspace_by_exact_name(criteria->workspace);
+		if (ws) {
+			workspace_for_each_container(ws, criteria_get_views_iterator, &data);
+		}
+	} else {
+		root_for_each_container(criteria_get_views_iterator, &data);
+	}
 	return matches;
 }
 
@@ -236,14 +439,74 @@ list_t *criteria_get_views(struct criteria *criteria) {
 // as an argument in several places.
 char *error = NULL;
 
-// Returns error string on failure or NULL otherwise.
-static bool generate_regex(pcre **regex, char *value) {
+/**
+ * Extract a literal from a regex if it doesn't use any regex features other
+ * than a leading ^ and trailing $. Escaped punctuation such as \. is accepted.
+ * Returns false if the value needs PCRE.
+ */
+static bool extract_literal(struct pattern *pattern, const char *value) {
+	size_t len = strlen(value);
+	bool anchored_start = len && value[0] == '^';
+	bool anchored_end = len > (size_t)anchored_start && value[len - 1] == '$'
+		&& (len < 2 || value[len - 2] != '\\');
+	if (anchored_end && !anchored_start) {
+		// Suffix matches are left to PCRE
+		return false;
+	}
+	const char *start = value + anchored_start;
+	const char *end = value + len - anchored_end;
+
+	char *literal = malloc(end - start + 1);
+	if (!literal) {
+		return false;
+	}
+	size_t literal_len = 0;
+	for (const char *c = start; c < end; ++c) {
+		if (*c == '\\') {
+			++c;
+			if (c == end || !ispunct((unsigned char)*c)) {
+				free(literal);
+				return false;
+			}
+		} else if (strchr("^$.[]|()?*+{}", *c)) {
+			free(literal);
+			return false;
+		}
+		literal[literal_len++] = *c;
+	}
+	literal[literal_len] = '\0';
+
+	pattern->literal = literal;
+	pattern->literal_len = literal_len;
+	if (anchored_start && anchored_end) {
+		pattern->match_type = PATTERN_EXACT;
+	} else if (anchored_start) {
+		pattern->match_type = PATTERN_PREFIX;
+	} else {
+		pattern->match_type = PATTERN_CONTAINS;
+	}
+	return true;
+}
+
+// Returns false and sets the error on failure.
+static bool generate_pattern(struct pattern **pattern, char *value) {
+	*pattern = calloc(1, sizeof(struct pattern));
+	if (!*pattern) {
+		error = strdup("Unable to allocate criteria pattern");
+		return false;
+	}
+	if (extract_literal(*pattern, value)) {
+		return true;
+	}
+
 	const char *reg_err;
 	int offset;
 
-	*regex = pcre_compile(value, PCRE_UTF8 | PCRE_UCP, &reg_err, &offset, NULL);
+	(*pattern)->match_type = PATTERN_PCRE;
+	(*pattern)->regex = pcre_compile(value, PCRE_UTF8 | PCRE_UCP,
+			&reg_err, &offset, NULL);
 
-	if (!*regex) {
+	if (!(*pattern)->regex) {
 		const char *fmt = "Regex compilation for '%s' failed: %s";
 		int len = strlen(fmt) + strlen(value) + strlen(reg_err) - 3;
 		error = malloc(len);
@@ -251,6 +514,14 @@ static bool generate_regex(pcre **regex, char *value) {
 		return false;
 	}
 
+	// The study data may be NULL without an error if there's nothing to gain
+	const char *study_err = NULL;
+	(*pattern)->regex_extra = pcre_study((*pattern)->regex,
+			PCRE_STUDY_JIT_COMPILE, &study_err);
+	if (study_err) {
+		wlr_log(WLR_DEBUG, "Unable to study regex '%s': %s", value, study_err);
+	}
+
 	return true;
 }
 
@@ -407,19 +678,19 @@ static bool parse_token(struct criteria *criteria, char *name, char *value) {
 	char *endptr = NULL;
 	switch (token) {
 	case T_TITLE:
-		generate_regex(&criteria->title, effective_value);
+		generate_pattern(&criteria->title, effective_value);
 		break;
 	case T_SHELL:
-		generate_regex(&criteria->shell, effective_value);
+		generate_pattern(&criteria->shell, effective_value);
 		break;
 	case T_APP_ID:
-		generate_regex(&criteria->app_id, effective_value);
+		generate_pattern(&criteria->app_id, effective_value);
 		break;
 	case T_CLASS:
-		generate_regex(&criteria->class, effective_value);
+		generate_pattern(&criteria->class, effective_value);
 		break;
 	case T_INSTANCE:
-		generate_regex(&criteria->instance, effective_value);
+		generate_pattern(&criteria->instance, effective_value);
 		break;
 	case T_CON_ID:
 		criteria->con_id = strtoul(effective_value, &endptr, 10);
@@ -428,10 +699,10 @@ static bool parse_token(struct criteria *criteria, char *name, char *value) {
 		}
 		break;
 	case T_CON_MARK:
-		generate_regex(&criteria->con_mark, effective_value);
+		generate_pattern(&criteria->con_mark, effective_value);
 		break;
 	case T_WINDOW_ROLE:
-		generate_regex(&criteria->window_role, effective_value);
+		generate_pattern(&criteria->window_role, effective_value);
 		break;
 	case T_WINDOW_TYPE:
 		// TODO: This is a string but will be stored as an enum or integer
@@ -507,6 +778,52 @@ static void unescape(char *value) {
 	free(copy);
 }
 
+static uint32_t criteria_get_depends(struct criteria *criteria) {
+	uint32_t depends = 0;
+	if (criteria->title) {
+		depends |= VIEW_MASK_TITLE;
+	}
+	if (criteria->shell) {
+		depends |= VIEW_MASK_SHELL;
+	}
+	if (criteria->app_id) {
+		depends |= VIEW_MASK_APP_ID;
+	}
+	if (criteria->class) {
+		depends |= VIEW_MASK_CLASS;
+	}
+	if (criteria->instance) {
+		depends |= VIEW_MASK_INSTANCE;
+	}
+	if (criteria->con_mark) {
+		depends |= VIEW_MASK_MARK;
+	}
+	if (criteria->con_id) {
+		depends |= VIEW_MASK_CON_ID;
+	}
+#ifdef HAVE_XWAYLAND
+	if (criteria->id) {
+		depends |= VIEW_MASK_X11_ID;
+	}
+#endif
+	if (criteria->window_role) {
+		depends |= VIEW_MASK_WINDOW_ROLE;
+	}
+	if (criteria->window_type) {
+		depends |= VIEW_MASK_WINDOW_TYPE;
+	}
+	if (criteria->floating || criteria->tiling) {
+		depends |= VIEW_MASK_FLOATING;
+	}
+	if (criteria->urgent) {
+		depends |= VIEW_MASK_URGENT;
+	}
+	if (criteria->workspace) {
+		depends |= VIEW_MASK_WORKSPACE;
+	}
+	return depends;
+}
+
 /**
  * Parse a raw criteria string such as [class="foo" instance="bar"] into a
  * criteria struct.
@@ -593,6 +910,7 @@ struct criteria *criteria_parse(char *raw, char **error_arg) {
 		*error_arg = strdup("Criteria is empty");
 		goto cleanup;
 	}
+	criteria->depends = criteria_get_depends(criteria);
 
 	++head;
 	int len = head - raw;
@@ -40,3 +40,22 @@ void desktop_damage_view(struct sway_view *view) {
 	};
 	desktop_damage_box(&box);
 }
+
+void desktop_get_resize_outline(struct sway_container *con,
+		struct wlr_box edges[static RESIZE_OUTLINE_EDGES]) {
+	int thickness = 2;
+	edges[0] = (struct wlr_box){ con->x, con->y, con->width, thickness };
+	edges[1] = (struct wlr_box){
+		con->x, con->y + con->height - thickness, con->width, thickness };
+	edges[2] = (struct wlr_box){ con->x, con->y, thickness, con->height };
+	edges[3] = (struct wlr_box){
+		con->x + con->width - thickness, con->y, thickness, con->height };
+}
+
+void desktop_damage_resize_outline(struct sway_container *con) {
+	struct wlr_box edges[RESIZE_OUTLINE_EDGES];
+	desktop_get_resize_outline(con, edges);
+	for (size_t i = 0; i < RESIZE_OUTLINE_EDGES; ++i) {
+		desktop_damage_box(&edges[i]);
+	}
+}
@@ -17,7 +17,9 @@
 #include "config.h"
 #include "sway/config.h"
 #include "sway/desktop/transaction.h"
+#include "sway/input/cursor.h"
 #include "sway/input/input-manager.h"
+#include "sway/input/latency.h"
 #include "sway/input/seat.h"
 #include "sway/layers.h"
 #include "sway/output.h"
@@ -300,23 +302,20 @@ static void send_frame_done_drag_icons(struct sway_output *output,
 		send_frame_done_iterator, when);
 }
 
-struct send_frame_done_data {
-	struct sway_output *output;
-	struct timespec *when;
-};
-
-static void send_frame_done_container_iterator(struct sway_container *con,
-		void *_data) {
-	if (con->type != C_VIEW) {
+static void send_frame_done_container(struct sway_output *output,
+		struct sway_container *con, struct timespec *when) {
+	if (!con->current.visible || con->destroying) {
 		return;
 	}
-	if (!view_is_visible(con->sway_view)) {
+	if (con->type == C_VIEW) {
+		output_view_for_each_surface(output, con->sway_view,
+			send_frame_done_iterator, when);
 		return;
 	}
-
-	struct send_frame_done_data *data = _data;
-	output_view_for_each_surface(data->output, con->sway_view,
-		send_frame_done_iterator, data->when);
+	list_t *children = con->current.children;
+	for (int i = 0; i < children->length; ++i) {
+		send_frame_done_container(output, children->items[i], when);
+	}
 }
 
 static void send_frame_done(struct sway_output *output, struct timespec *when) {
@@ -324,16 +323,12 @@ static void send_frame_done(struct sway_output *output, struct timespec *when) {
 		goto send_frame_overlay;
 	}
 
-	struct send_frame_done_data data = {
-		.output = output,
-		.when = when,
-	};
+	// Only the visible parts of the workspace's current tree are walked, using
+	// the visibility which was calculated when the last transaction was applied.
 	struct sway_container *workspace = output_get_active_workspace(output);
 	if (workspace->current.ws_fullscreen) {
-		send_frame_done_container_iterator(
-				workspace->current.ws_fullscreen, &data);
-		container_for_each_child(workspace->current.ws_fullscreen,
-				send_frame_done_container_iterator, &data);
+		send_frame_done_container(output,
+				workspace->current.ws_fullscreen, when);
 #ifdef HAVE_XWAYLAND
 		send_frame_done_unmanaged(output,
 			&root_container.sway_root->xwayland_unmanaged, when);
@@ -344,8 +339,11 @@ static void send_frame_done(struct sway_output *output, struct timespec *when) {
 		send_frame_done_layer(output,
 			&output->layers[ZWLR_LAYER_SHELL_V1_LAYER_BOTTOM], when);
 
-		workspace_for_each_container(workspace,
-				send_frame_done_container_iterator, &data);
+		send_frame_done_container(output, workspace, when);
+		list_t *floating = workspace->current.ws_floating;
+		for (int i = 0; floating && i < floating->length; ++i) {
+			send_frame_done_container(output, floating->items[i], when);
+		}
 
 #ifdef HAVE_XWAYLAND
 		send_frame_done_unmanaged(output,
@@ -370,9 +368,20 @@ static void damage_handle_frame(struct wl_listener *listener, void *data) {
 		return;
 	}
 
+	// Process pointer motion which was held back until the next frame
+	struct sway_seat *seat;
+	wl_list_for_each(seat, &input_manager->seats, link) {
+		cursor_flush_motion(seat->cursor);
+	}
+
+	// The previous frame has been presented by now
+	latency_output_present(output);
+
 	struct timespec now;
 	clock_gettime(CLOCK_MONOTONIC, &now);
 
+	output->frame_stats.frames++;
+
 	bool needs_swap;
 	pixman_region32_t damage;
 	pixman_region32_init(&damage);
@@ -392,6 +401,7 @@ static void damage_handle_frame(struct wl_listener *listener, void *data) {
 
 void output_damage_whole(struct sway_output *output) {
 	wlr_output_damage_add_whole(output->damage);
+	latency_damage(output);
 }
 
 static void damage_surface_iterator(struct sway_output *output,
@@ -435,6 +445,10 @@ static void damage_surface_iterator(struct sway_output *output,
 		wlr_output_damage_add_box(output->damage, &box);
 	}
 
+	if (whole || pixman_region32_not_empty(&surface->buffer_damage)) {
+		latency_damage(output);
+	}
+
 	wlr_output_schedule_frame(output->wlr_output);
 }
 
@@ -470,6 +484,7 @@ void output_damage_box(struct sway_output *output, struct wlr_box *_box) {
 	box.y -= output->swayc->current.swayc_y;
 	scale_box(&box, output->wlr_output->scale);
 	wlr_output_damage_add_box(output->damage, &box);
+	latency_damage(output);
 }
 
 static void output_damage_whole_container_iterator(struct sway_container *con,
@@ -494,6 +509,7 @@ void output_damage_whole_container(struct sway_output *output,
 	};
 	scale_box(&box, output->wlr_output->scale);
 	wlr_output_damage_add_box(output->damage, &box);
+	latency_damage(output);
 }
 
 static void damage_handle_destroy(struct wl_listener *listener, void *data) {
@@ -17,7 +17,9 @@
 #include "config.h"
 #include "sway/config.h"
 #include "sway/debug.h"
+#include "sway/desktop.h"
 #include "sway/input/input-manager.h"
+#include "sway/input/latency.h"
 #include "sway/input/seat.h"
 #include "sway/layers.h"
 #include "sway/output.h"
@@ -146,37 +148,98 @@ static void render_drag_icons(struct sway_output *output,
 		render_surface_iterator, &data);
 }
 
+struct batched_rect {
+	struct wlr_box box;
+	float color[4];
+};
+
+/**
+ * Solid rectangles such as borders and titlebar padding are not drawn
+ * immediately. Instead they are collected here and drawn by flush_rects(),
+ * which sets each damage rectangle as the scissor only once for the whole
+ * batch.
+ *
+ * The batch must be flushed before rendering anything which may overlap the
+ * rectangles, such as view surfaces and floating containers, and is empty
+ * between frames.
+ */
+static struct {
+	struct batched_rect *rects;
+	size_t length;
+	size_t capacity;
+} rect_batch;
+
 static void render_rect(struct wlr_output *wlr_output,
 		pixman_region32_t *output_damage, const struct wlr_box *_box,
 		float color[static 4]) {
-	struct wlr_renderer *renderer =
-		wlr_backend_get_renderer(wlr_output->backend);
-
 	struct wlr_box box;
 	memcpy(&box, _box, sizeof(struct wlr_box));
 	box.x -= wlr_output->lx * wlr_output->scale;
 	box.y -= wlr_output->ly * wlr_output->scale;
 
-	pixman_region32_t damage;
-	pixman_region32_init(&damage);
-	pixman_region32_union_rect(&damage, &damage, box.x, box.y,
-		box.width, box.height);
-	pixman_region32_intersect(&damage, &damage, output_damage);
-	bool damaged = pixman_region32_not_empty(&damage);
-	if (!damaged) {
-		goto damage_finish;
+	pixman_box32_t rect = {
+		.x1 = box.x,
+		.y1 = box.y,
+		.x2 = box.x + box.width,
+		.y2 = box.y + box.height,
+	};
+	if (box.width <= 0 || box.height <= 0 ||
+			pixman_region32_contains_rectangle(output_damage, &rect)
+				== PIXMAN_REGION_OUT) {
+		return;
+	}
+
+	if (rect_batch.length == rect_batch.capacity) {
+		size_t capacity = rect_batch.capacity ? rect_batch.capacity * 2 : 64;
+		struct batched_rect *rects = realloc(rect_batch.rects,
+				capacity * sizeof(struct batched_rect));
+		if (!rects) {
+			wlr_log(WLR_ERROR, "Unable to grow rect batch");
+			return;
+		}
+		rect_batch.rects = rects;
+		rect_batch.capacity = capacity;
+	}
+	struct batched_rect *batched = &rect_batch.rects[rect_batch.length++];
+	batched->box = box;
+	memcpy(batched->color, color, sizeof(float) * 4);
+}
+
+static void flush_rects(struct wlr_output *wlr_output,
+		pixman_region32_t *output_damage) {
+	if (!rect_batch.length) {
+		return;
 	}
+	struct wlr_renderer *renderer =
+		wlr_backend_get_renderer(wlr_output->backend);
 
 	int nrects;
-	pixman_box32_t *rects = pixman_region32_rectangles(&damage, &nrects);
+	pixman_box32_t *rects = pixman_region32_rectangles(output_damage, &nrects);
 	for (int i = 0; i < nrects; ++i) {
-		scissor_output(wlr_output, &rects[i]);
-		wlr_render_rect(renderer, &box, color,
-			wlr_output->transform_matrix);
+		struct wlr_box damage_box = {
+			.x = rects[i].x1,
+			.y = rects[i].y1,
+			.width = rects[i].x2 - rects[i].x1,
+			.height = rects[i].y2 - rects[i].y1,
+		};
+		bool scissored = false;
+		for (size_t j = 0; j < rect_batch.length; ++j) {
+			struct batched_rect *batched = &rect_batch.rects[j];
+			struct wlr_box intersection;
+			if (!wlr_box_intersection(&damage_box, &batched->box,
+						&intersection)) {
+				continue;
+			}
+			if (!scissored) {
+				scissor_output(wlr_output, &rects[i]);
+				scissored = true;
+			}
+			wlr_render_rect(renderer, &batched->box, batched->color,
+				wlr_output->transform_matrix);
+		}
 	}
 
-damage_finish:
-	pixman_region32_fini(&damage);
+	rect_batch.length = 0;
 }
 
 static void premultiply_alpha(float color[4], float opacity) {
@@ -225,37 +288,42 @@ static void render_saved_view(struct sway_view *view,
 		struct sway_output *output, pixman_region32_t *damage, float alpha) {
 	struct wlr_output *wlr_output = output->wlr_output;
 
-	if (!view->saved_buffer || !view->saved_buffer->texture) {
-		return;
-	}
-	struct wlr_box box = {
-		.x = view->swayc->current.view_x - output->swayc->current.swayc_x -
-			view->saved_geometry.x,
-		.y = view->swayc->current.view_y - output->swayc->current.swayc_y -
-			view->saved_geometry.y,
-		.width = view->saved_buffer_width,
-		.height = view->saved_buffer_height,
-	};
-
 	struct wlr_box output_box = {
 		.width = output->swayc->current.swayc_width,
 		.height = output->swayc->current.swayc_height,
 	};
 
-	struct wlr_box intersection;
-	bool intersects = wlr_box_intersection(&output_box, &box, &intersection);
-	if (!intersects) {
-		return;
-	}
+	struct sway_saved_buffer *saved_buf;
+	wl_list_for_each(saved_buf, &view->saved_buffers, link) {
+		if (!saved_buf->buffer->texture) {
+			continue;
+		}
+		struct wlr_box box = {
+			.x = view->swayc->current.view_x - output->swayc->current.swayc_x -
+				view->saved_geometry.x + saved_buf->x,
+			.y = view->swayc->current.view_y - output->swayc->current.swayc_y -
+				view->saved_geometry.y + saved_buf->y,
+			.width = saved_buf->width,
+			.height = saved_buf->height,
+		};
+
+		struct wlr_box intersection;
+		bool intersects = wlr_box_intersection(&output_box, &box, &intersection);
+		if (!intersects) {
+			continue;
+		}
 
-	scale_box(&box, wlr_output->scale);
+		scale_box(&box, wlr_output->scale);
 
-	float matrix[9];
-	wlr_matrix_project_box(matrix, &box, WL_OUTPUT_TRANSFORM_NORMAL, 0,
-		wlr_output->transform_matrix);
+		float matrix[9];
+		enum wl_output_transform transform =
+			wlr_output_transform_invert(saved_buf->transform);
+		wlr_matrix_project_box(matrix, &box, transform, 0,
+			wlr_output->transform_matrix);
 
-	render_texture(wlr_output, damage, view->saved_buffer->texture,
-			&box, matrix, alpha);
+		render_texture(wlr_output, damage, saved_buf->buffer->texture,
+				&box, matrix, alpha);
+	}
 }
 
 /**
@@ -264,9 +332,13 @@ static void render_saved_view(struct sway_view *view,
 static void render_view(struct sway_output *output, pixman_region32_t *damage,
 		struct sway_container *con, struct border_colors *colors) {
 	struct sway_view *view = con->sway_view;
-	if (view->saved_buffer) {
+	// Surfaces may extend past the view, over borders rendered before it
+	flush_rects(output->wlr_output, damage);
+	if (view_has_saved_buffer(view)) {
 		render_saved_view(view, output, damage, view->swayc->alpha);
-	} else {
+	} else if (view->surface) {
+		// Views without a configure in flight have no saved buffers, so they
+		// may have been unmapped while still in the current tree
 		render_view_toplevels(view, output, damage, view->swayc->alpha);
 	}
 
@@ -789,6 +861,8 @@ static void render_floating_container(struct sway_output *soutput,
 	} else {
 		render_container(soutput, damage, con, con->current.focused);
 	}
+	// Floating containers may overlap each other
+	flush_rects(soutput->wlr_output, damage);
 }
 
 static void render_floating(struct sway_output *soutput,
@@ -810,6 +884,38 @@ static void render_floating(struct sway_output *soutput,
 	}
 }
 
+/**
+ * Draw an outline of the size containers are being interactively resized to,
+ * for as long as their views haven't caught up with it.
+ */
+static void render_resize_outlines(struct sway_output *output,
+		pixman_region32_t *damage) {
+	struct wlr_output *wlr_output = output->wlr_output;
+	struct sway_seat *seat;
+	wl_list_for_each(seat, &input_manager->seats, link) {
+		if (seat->operation != OP_RESIZE_FLOATING &&
+				seat->operation != OP_RESIZE_TILING) {
+			continue;
+		}
+		struct sway_container *con = seat->op_container;
+		if (con->x == con->current.swayc_x &&
+				con->y == con->current.swayc_y &&
+				con->width == con->current.swayc_width &&
+				con->height == con->current.swayc_height) {
+			continue;
+		}
+		float color[4];
+		memcpy(color, config->border_colors.focused.border, sizeof(color));
+		struct wlr_box edges[RESIZE_OUTLINE_EDGES];
+		desktop_get_resize_outline(con, edges);
+		for (size_t i = 0; i < RESIZE_OUTLINE_EDGES; ++i) {
+			scale_box(&edges[i], wlr_output->scale);
+			render_rect(wlr_output, damage, &edges[i], color);
+		}
+	}
+	flush_rects(wlr_output, damage);
+}
+
 void output_render(struct sway_output *output, struct timespec *when,
 		pixman_region32_t *damage) {
 	struct wlr_output *wlr_output = output->wlr_output;
@@ -821,12 +927,17 @@ void output_render(struct sway_output *output, struct timespec *when,
 		return;
 	}
 
+	if (!sway_assert(rect_batch.length == 0, "Rect batch wasn't flushed")) {
+		rect_batch.length = 0;
+	}
+
 	wlr_renderer_begin(renderer, wlr_output->width, wlr_output->height);
 
 	if (!pixman_region32_not_empty(damage)) {
 		// Output isn't damaged but needs buffer swap
 		goto renderer_end;
 	}
+	output->frame_stats.composited++;
 
 	if (debug.damage == DAMAGE_HIGHLIGHT) {
 		wlr_renderer_clear(renderer, (float[]){1, 1, 0, 1});
@@ -855,7 +966,7 @@ void output_render(struct sway_output *output, struct timespec *when,
 
 		// TODO: handle views smaller than the output
 		if (fullscreen_con->type == C_VIEW) {
-			if (fullscreen_con->sway_view->saved_buffer) {
+			if (view_has_saved_buffer(fullscreen_con->sway_view)) {
 				render_saved_view(fullscreen_con->sway_view,
 						output, damage, 1.0f);
 			} else {
@@ -865,6 +976,7 @@ void output_render(struct sway_output *output, struct timespec *when,
 		} else {
 			render_container(output, damage, fullscreen_con,
 					fullscreen_con->current.focused);
+			flush_rects(wlr_output, damage);
 		}
 #ifdef HAVE_XWAYLAND
 		render_unmanaged(output, damage,
@@ -886,6 +998,7 @@ void output_render(struct sway_output *output, struct timespec *when,
 			&output->layers[ZWLR_LAYER_SHELL_V1_LAYER_BOTTOM]);
 
 		render_container(output, damage, workspace, workspace->current.focused);
+		flush_rects(wlr_output, damage);
 		render_floating(output, damage);
 #ifdef HAVE_XWAYLAND
 		render_unmanaged(output, damage,
@@ -900,6 +1013,7 @@ void output_render(struct sway_output *output, struct timespec *when,
 	if (focus && focus->type == C_VIEW) {
 		render_view_popups(focus->sway_view, output, damage, focus->alpha);
 	}
+	render_resize_outlines(output, damage);
 
 render_overlay:
 	render_layer(output, damage,
@@ -924,4 +1038,5 @@ renderer_end:
 		return;
 	}
 	output->last_frame = *when;
+	latency_output_commit(output);
 }
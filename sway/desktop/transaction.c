@@ -12,6 +12,7 @@
 #include "sway/desktop/transaction.h"
 #include "sway/output.h"
 #include "sway/tree/container.h"
+#include "sway/tree/root.h"
 #include "sway/tree/view.h"
 #include "sway/tree/workspace.h"
 #include "list.h"
@@ -153,6 +154,44 @@ static void transaction_add_container(struct sway_transaction *transaction,
 	container->ntxnrefs++;
 }
 
+/**
+ * Recursively set the current visibility of a container and its descendants.
+ *
+ * This only uses the current state so it matches what the renderer draws, and
+ * means it only needs to be done once per applied transaction rather than on
+ * every frame.
+ */
+static void apply_visibility(struct sway_container *con, bool visible) {
+	con->current.visible = visible;
+	if (con->type == C_VIEW) {
+		return;
+	}
+	struct sway_container_state *state = &con->current;
+	for (int i = 0; i < state->children->length; ++i) {
+		struct sway_container *child = state->children->items[i];
+		bool child_visible = visible;
+		if (state->layout == L_TABBED || state->layout == L_STACKED) {
+			child_visible = visible && child == state->focused_inactive_child;
+		}
+		if (con->type == C_WORKSPACE && state->ws_fullscreen) {
+			child_visible = false;
+		}
+		apply_visibility(child, child_visible);
+	}
+	if (con->type != C_WORKSPACE) {
+		return;
+	}
+	if (state->ws_floating) {
+		for (int i = 0; i < state->ws_floating->length; ++i) {
+			apply_visibility(state->ws_floating->items[i],
+					visible && !state->ws_fullscreen);
+		}
+	}
+	if (state->ws_fullscreen) {
+		apply_visibility(state->ws_fullscreen, visible);
+	}
+}
+
 /**
  * Apply a transaction to the "current" state of the tree.
  */
@@ -167,6 +206,7 @@ static void transaction_apply(struct sway_transaction *transaction) {
 		wlr_log(WLR_DEBUG, "Transaction %p: %.1fms waiting "
 				"(%.1f frames if 60Hz)", transaction, ms, ms / (1000.0f / 60));
 	}
+	root_container.sway_root->generation++;
 
 	// Apply the instruction state to the container's current state
 	for (int i = 0; i < transaction->instructions->length; ++i) {
@@ -176,15 +216,21 @@ static void transaction_apply(struct sway_transaction *transaction) {
 
 		// Damage the old location
 		desktop_damage_whole_container(container);
-		if (container->type == C_VIEW && container->sway_view->saved_buffer) {
+		if (container->type == C_VIEW &&
+				view_has_saved_buffer(container->sway_view)) {
 			struct sway_view *view = container->sway_view;
-			struct wlr_box box = {
-				.x = container->current.view_x - view->saved_geometry.x,
-				.y = container->current.view_y - view->saved_geometry.y,
-				.width = view->saved_buffer_width,
-				.height = view->saved_buffer_height,
-			};
-			desktop_damage_box(&box);
+			struct sway_saved_buffer *saved_buf;
+			wl_list_for_each(saved_buf, &view->saved_buffers, link) {
+				struct wlr_box box = {
+					.x = container->current.view_x - view->saved_geometry.x +
+						saved_buf->x,
+					.y = container->current.view_y - view->saved_geometry.y +
+						saved_buf->y,
+					.width = saved_buf->width,
+					.height = saved_buf->height,
+				};
+				desktop_damage_box(&box);
+			}
 		}
 
 		// There are separate children lists for each instruction state, the
@@ -198,7 +244,8 @@ static void transaction_apply(struct sway_transaction *transaction) {
 		memcpy(&container->current, &instruction->state,
 				sizeof(struct sway_container_state));
 
-		if (container->type == C_VIEW && container->sway_view->saved_buffer) {
+		if (container->type == C_VIEW &&
+				view_has_saved_buffer(container->sway_view)) {
 			if (!container->destroying || container->ntxnrefs == 1) {
 				view_remove_saved_buffer(container->sway_view);
 			}
@@ -223,10 +270,19 @@ static void transaction_apply(struct sway_transaction *transaction) {
 			container_discover_outputs(container);
 		}
 	}
+
+	apply_visibility(&root_container, true);
 }
 
 static void transaction_commit(struct sway_transaction *transaction);
 
+// Set when dirty containers were left for when the queue is empty
+static bool throttled_dirty = false;
+
+static void handle_throttled_commit(void *data) {
+	transaction_commit_dirty();
+}
+
 // Return true if both transactions operate on the same containers
 static bool transaction_same_containers(struct sway_transaction *a,
 		struct sway_transaction *b) {
@@ -259,6 +315,12 @@ static void transaction_progress_queue() {
 
 	if (!server.transactions->length) {
 		idle_inhibit_v1_check_active(server.idle_inhibit_manager_v1);
+		if (throttled_dirty) {
+			// Commit outside of whatever handler made this transaction ready
+			throttled_dirty = false;
+			wl_event_loop_add_idle(server.wl_event_loop,
+					handle_throttled_commit, NULL);
+		}
 		return;
 	}
 
@@ -312,7 +374,8 @@ static void transaction_commit(struct sway_transaction *transaction) {
 		struct sway_transaction_instruction *instruction =
 			transaction->instructions->items[i];
 		struct sway_container *con = instruction->container;
-		if (should_configure(con, instruction)) {
+		bool configure = should_configure(con, instruction);
+		if (configure) {
 			instruction->serial = view_configure(con->sway_view,
 					instruction->state.view_x,
 					instruction->state.view_y,
@@ -327,7 +390,11 @@ static void transaction_commit(struct sway_transaction *transaction) {
 			struct timespec when;
 			wlr_surface_send_frame_done(con->sway_view->surface, &when);
 		}
-		if (con->type == C_VIEW && !con->sway_view->saved_buffer) {
+		// Views which aren't being resized keep rendering their live
+		// surfaces, so only save buffers for views which need a configure
+		// or which are going away.
+		if (con->type == C_VIEW && (configure || con->destroying) &&
+				!view_has_saved_buffer(con->sway_view)) {
 			view_save_buffer(con->sway_view);
 			memcpy(&con->sway_view->saved_geometry, &con->sway_view->geometry,
 					sizeof(struct wlr_box));
@@ -437,3 +504,11 @@ void transaction_commit_dirty(void) {
 		transaction_progress_queue();
 	}
 }
+
+void transaction_commit_dirty_throttled(void) {
+	if (server.transactions->length) {
+		throttled_dirty = server.dirty_containers->length > 0;
+		return;
+	}
+	transaction_commit_dirty();
+}
@@ -469,7 +469,7 @@ static void handle_set_title(struct wl_listener *listener, void *data) {
 		return;
 	}
 	view_update_title(view, false);
-	view_execute_criteria(view);
+	view_execute_criteria(view, VIEW_MASK_TITLE);
 }
 
 static void handle_set_class(struct wl_listener *listener, void *data) {
@@ -480,7 +480,7 @@ static void handle_set_class(struct wl_listener *listener, void *data) {
 	if (!xsurface->mapped) {
 		return;
 	}
-	view_execute_criteria(view);
+	view_execute_criteria(view, VIEW_MASK_CLASS | VIEW_MASK_INSTANCE);
 }
 
 static void handle_set_window_type(struct wl_listener *listener, void *data) {
@@ -491,7 +491,7 @@ static void handle_set_window_type(struct wl_listener *listener, void *data) {
 	if (!xsurface->mapped) {
 		return;
 	}
-	view_execute_criteria(view);
+	view_execute_criteria(view, VIEW_MASK_WINDOW_TYPE);
 }
 
 static void handle_set_hints(struct wl_listener *listener, void *data) {
@@ -6,9 +6,13 @@
 #include <dev/evdev/input-event-codes.h>
 #endif
 #include <limits.h>
+#include <stdint.h>
 #include <wlr/types/wlr_cursor.h>
 #include <wlr/types/wlr_xcursor_manager.h>
 #include <wlr/types/wlr_idle.h>
+#include <wlr/types/wlr_pointer_constraints_v1.h>
+#include <wlr/types/wlr_relative_pointer_v1.h>
+#include <wlr/util/region.h>
 #include "list.h"
 #include "log.h"
 #include "config.h"
@@ -17,6 +21,7 @@
 #include "sway/desktop/transaction.h"
 #include "sway/input/cursor.h"
 #include "sway/input/keyboard.h"
+#include "sway/input/latency.h"
 #include "sway/layers.h"
 #include "sway/output.h"
 #include "sway/tree/arrange.h"
@@ -138,6 +143,103 @@ static struct sway_container *container_at_coords(
 	return output->swayc;
 }
 
+static bool floating_overlaps(struct sway_container *con) {
+	for (int i = 0; i < root_container.children->length; ++i) {
+		struct sway_container *output = root_container.children->items[i];
+		for (int j = 0; j < output->children->length; ++j) {
+			struct sway_container *ws = output->children->items[j];
+			if (!workspace_is_visible(ws)) {
+				continue;
+			}
+			list_t *floating = ws->sway_workspace->floating;
+			for (int k = 0; k < floating->length; ++k) {
+				struct sway_container *floater = floating->items[k];
+				if (floater->x < con->x + con->width &&
+						con->x < floater->x + floater->width &&
+						floater->y < con->y + con->height &&
+						con->y < floater->y + floater->height) {
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+/**
+ * Returns true if nothing container_at_coords looks at before the views of the
+ * tiling layout can be above the given view. Only cheap checks are done here,
+ * those which depend on the layout are done once per generation.
+ */
+static bool view_is_on_top(struct sway_seat *seat, struct sway_container *c) {
+#ifdef HAVE_XWAYLAND
+	if (!wl_list_empty(&root_container.sway_root->xwayland_unmanaged)) {
+		return false;
+	}
+#endif
+	struct sway_container *output = container_parent(c, C_OUTPUT);
+	if (!output || !wl_list_empty(&output->sway_output->layers[
+				ZWLR_LAYER_SHELL_V1_LAYER_OVERLAY]) ||
+			!wl_list_empty(&output->sway_output->layers[
+				ZWLR_LAYER_SHELL_V1_LAYER_TOP])) {
+		return false;
+	}
+	// Popups of the focused view are above every other view. container_at
+	// uses the current seat for this, and the cursor's seat picks the
+	// workspace.
+	struct sway_seat *current_seat = input_manager_current_seat(input_manager);
+	return seat_get_focus_inactive(seat, &root_container) == c &&
+		seat_get_focus_inactive(current_seat, &root_container) == c;
+}
+
+static bool hit_is_current(struct sway_hit *hit) {
+	return hit->valid &&
+		hit->generation == root_container.sway_root->generation;
+}
+
+/**
+ * If the point is still over a surface of the focused tiling view found last
+ * time, and neither the layout nor anything which could be drawn over the view
+ * changed, the view's surfaces are the only ones which need to be tested.
+ */
+struct sway_container *cursor_hit_test(struct sway_cursor *cursor,
+		struct sway_hit *hit, double lx, double ly,
+		struct wlr_surface **surface, double *sx, double *sy) {
+	struct sway_seat *seat = cursor->seat;
+	if (!hit) {
+		return container_at_coords(seat, lx, ly, surface, sx, sy);
+	}
+	struct sway_container *c = hit->container;
+	if (hit_is_current(hit) && hit->unobscured && view_is_on_top(seat, c)) {
+		struct wlr_box box = {
+			.x = c->x,
+			.y = c->y,
+			.width = c->width,
+			.height = c->height,
+		};
+		struct sway_container *output = container_parent(c, C_OUTPUT);
+		if (wlr_box_contains_point(&box, lx, ly) &&
+				wlr_output_layout_output_at(
+					root_container.sway_root->output_layout, lx, ly) ==
+				output->sway_output->wlr_output) {
+			*surface = NULL;
+			tiling_container_at(c, lx, ly, surface, sx, sy);
+			if (*surface) {
+				return c;
+			}
+		}
+	}
+
+	c = container_at_coords(seat, lx, ly, surface, sx, sy);
+	hit->valid = true;
+	hit->generation = root_container.sway_root->generation;
+	hit->container = c;
+	hit->unobscured = c && *surface && c->type == C_VIEW &&
+		!container_is_floating_or_child(c) && view_is_on_top(seat, c) &&
+		!floating_overlaps(c);
+	return c;
+}
+
 /**
  * Determine if the edge of the given container is on the edge of the
  * workspace/output.
@@ -280,6 +382,7 @@ static void handle_resize_floating_motion(struct sway_seat *seat,
 		struct sway_cursor *cursor) {
 	struct sway_container *con = seat->op_container;
 	enum wlr_edges edge = seat->op_resize_edge;
+	desktop_damage_resize_outline(con);
 
 	// The amount the mouse has moved since the start of the resize operation
 	// Positive is down/right
@@ -366,6 +469,7 @@ static void handle_resize_floating_motion(struct sway_seat *seat,
 	}
 
 	arrange_windows(con);
+	desktop_damage_resize_outline(con);
 }
 
 static void handle_resize_tiling_motion(struct sway_seat *seat,
@@ -377,6 +481,7 @@ static void handle_resize_tiling_motion(struct sway_seat *seat,
 	enum wlr_edges edge_x = WLR_EDGE_NONE;
 	enum wlr_edges edge_y = WLR_EDGE_NONE;
 	struct sway_container *con = seat->op_container;
+	desktop_damage_resize_outline(con);
 
 	if (seat->op_resize_edge & WLR_EDGE_TOP) {
 		amount_y = (seat->op_ref_height - moved_y) - con->height;
@@ -399,6 +504,7 @@ static void handle_resize_tiling_motion(struct sway_seat *seat,
 	if (amount_y != 0) {
 		container_resize_tiled(seat->op_container, edge_y, amount_y);
 	}
+	desktop_damage_resize_outline(con);
 }
 
 void cursor_send_pointer_motion(struct sway_cursor *cursor, uint32_t time_msec,
@@ -428,6 +534,7 @@ void cursor_send_pointer_motion(struct sway_cursor *cursor, uint32_t time_msec,
 		}
 		cursor->previous.x = cursor->cursor->x;
 		cursor->previous.y = cursor->cursor->y;
+		cursor->hit.valid = false;
 		return;
 	}
 
@@ -435,14 +542,19 @@ void cursor_send_pointer_motion(struct sway_cursor *cursor, uint32_t time_msec,
 	struct wlr_surface *surface = NULL;
 	double sx, sy;
 
-	// Find the container beneath the pointer's previous position
-	struct sway_container *prev_c = container_at_coords(seat,
-			cursor->previous.x, cursor->previous.y, &surface, &sx, &sy);
+	// Find the container beneath the pointer's previous position, which is
+	// known from the last motion unless the layout changed since
+	struct sway_container *prev_c = cursor->hit.container;
+	if (!hit_is_current(&cursor->hit)) {
+		prev_c = container_at_coords(seat,
+				cursor->previous.x, cursor->previous.y, &surface, &sx, &sy);
+		surface = NULL;
+	}
 	// Update the stored previous position
 	cursor->previous.x = cursor->cursor->x;
 	cursor->previous.y = cursor->cursor->y;
 
-	struct sway_container *c = container_at_coords(seat,
+	struct sway_container *c = cursor_hit_test(cursor, &cursor->hit,
 			cursor->cursor->x, cursor->cursor->y, &surface, &sx, &sy);
 	if (c && config->focus_follows_mouse && allow_refocusing) {
 		struct sway_container *focus = seat_get_focus(seat);
@@ -507,6 +619,8 @@ void cursor_send_pointer_motion(struct sway_cursor *cursor, uint32_t time_msec,
 	// send pointer enter/leave
 	if (surface != NULL) {
 		if (seat_is_input_allowed(seat, surface)) {
+			cursor->focus_ox = cursor->cursor->x - sx;
+			cursor->focus_oy = cursor->cursor->y - sy;
 			wlr_seat_pointer_notify_enter(wlr_seat, surface, sx, sy);
 			wlr_seat_pointer_notify_motion(wlr_seat, time_msec, sx, sy);
 		}
@@ -521,14 +635,247 @@ void cursor_send_pointer_motion(struct sway_cursor *cursor, uint32_t time_msec,
 	}
 }
 
+/**
+ * Returns true if the cursor has moved since pointer motion was last processed.
+ * Motion which doesn't move the cursor, such as relative motion clamped at the
+ * edge of the layout, doesn't need to be hit tested or sent to clients.
+ */
+static bool cursor_has_moved(struct sway_cursor *cursor) {
+	return cursor->cursor->x != cursor->previous.x ||
+		cursor->cursor->y != cursor->previous.y;
+}
+
+static void cursor_process_motion(struct sway_cursor *cursor) {
+	cursor->motion_pending = false;
+	clock_gettime(CLOCK_MONOTONIC, &cursor->motion_processed);
+	cursor_send_pointer_motion(cursor, cursor->motion_time_msec, true);
+	// Views being resized are only configured again once they've caught up.
+	// The outline of their new size is drawn until then.
+	if (cursor->seat->operation == OP_RESIZE_FLOATING ||
+			cursor->seat->operation == OP_RESIZE_TILING) {
+		transaction_commit_dirty_throttled();
+	} else {
+		transaction_commit_dirty();
+	}
+}
+
+void cursor_flush_motion(struct sway_cursor *cursor) {
+	if (cursor->motion_pending) {
+		cursor_process_motion(cursor);
+	}
+}
+
+static int handle_motion_timer(void *data) {
+	struct sway_cursor *cursor = data;
+	cursor_flush_motion(cursor);
+	return 0;
+}
+
+/**
+ * Send motion which is held back to the surface with pointer focus right away,
+ * as long as the cursor is still within that surface. Entering and leaving
+ * surfaces waits until the motion is processed.
+ */
+static void cursor_forward_motion(struct sway_cursor *cursor,
+		uint32_t time_msec) {
+	struct wlr_seat *wlr_seat = cursor->seat->wlr_seat;
+	struct wlr_surface *surface = wlr_seat->pointer_state.focused_surface;
+	if (!surface || cursor->seat->operation != OP_NONE) {
+		return;
+	}
+	double sx = cursor->cursor->x - cursor->focus_ox;
+	double sy = cursor->cursor->y - cursor->focus_oy;
+	if (sx >= 0 && sy >= 0 && sx < surface->current.width &&
+			sy < surface->current.height) {
+		wlr_seat_pointer_notify_motion(wlr_seat, time_msec, sx, sy);
+	}
+}
+
+/**
+ * Handle motion of the cursor, which is either processed right away or held
+ * back according to the seat's motion_coalescing setting. The cursor image
+ * always moves right away.
+ */
+static void cursor_handle_motion(struct sway_cursor *cursor,
+		uint32_t time_msec) {
+	struct seat_config *seat_config = seat_get_config(cursor->seat);
+	enum seat_config_motion_coalescing mode = seat_config ?
+		seat_config->motion_coalescing : MOTION_COALESCING_DEFAULT;
+	cursor->motion_time_msec = time_msec;
+	if (mode == MOTION_COALESCING_DEFAULT ||
+			mode == MOTION_COALESCING_DISABLE) {
+		cursor_process_motion(cursor);
+		return;
+	}
+
+	cursor_forward_motion(cursor, time_msec);
+	if (cursor->motion_pending) {
+		return;
+	}
+
+	if (mode == MOTION_COALESCING_FRAME) {
+		struct wlr_output *output = wlr_output_layout_output_at(
+				root_container.sway_root->output_layout,
+				cursor->cursor->x, cursor->cursor->y);
+		if (!output || !output->enabled) {
+			// No frame will come to process the motion
+			cursor_process_motion(cursor);
+			return;
+		}
+		// The cursor may be a hardware cursor, which doesn't cause frames
+		cursor->motion_pending = true;
+		wlr_output_schedule_frame(output);
+		return;
+	}
+
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	int interval = 1000 / seat_config->motion_rate;
+	int64_t elapsed =
+		(int64_t)(now.tv_sec - cursor->motion_processed.tv_sec) * 1000 +
+		(now.tv_nsec - cursor->motion_processed.tv_nsec) / 1000000;
+	// Motion is never held back when none has been processed yet
+	bool processed = cursor->motion_processed.tv_sec != 0 ||
+		cursor->motion_processed.tv_nsec != 0;
+	if (!processed || elapsed >= interval || elapsed < 0) {
+		cursor_process_motion(cursor);
+		return;
+	}
+	// Zero would disarm the timer
+	int delay = interval - (int)elapsed;
+	if (delay < 1) {
+		delay = 1;
+	}
+	if (!cursor->motion_timer) {
+		cursor->motion_timer = wl_event_loop_add_timer(server.wl_event_loop,
+				handle_motion_timer, cursor);
+	}
+	if (!cursor->motion_timer || wl_event_source_timer_update(
+				cursor->motion_timer, delay) < 0) {
+		wlr_log(WLR_DEBUG, "failed to set motion timer");
+		cursor_process_motion(cursor);
+		return;
+	}
+	cursor->motion_pending = true;
+}
+
+/**
+ * Get the layout coordinates of the origin of the constrained surface. Returns
+ * false if it isn't the surface of a mapped view.
+ */
+static bool constraint_surface_origin(
+		struct wlr_pointer_constraint_v1 *constraint, double *ox, double *oy) {
+	struct sway_view *view = view_from_wlr_surface(constraint->surface);
+	if (!view || !view->swayc) {
+		return false;
+	}
+	*ox = view->swayc->current.view_x - view->geometry.x;
+	*oy = view->swayc->current.view_y - view->geometry.y;
+	return true;
+}
+
+/**
+ * Warp the cursor into the region of the active constraint if it's outside of
+ * it, and give the constrained surface pointer focus.
+ */
+static void cursor_warp_into_constraint(struct sway_cursor *cursor,
+		uint32_t time_msec) {
+	struct wlr_pointer_constraint_v1 *constraint = cursor->active_constraint;
+	double ox, oy;
+	if (!constraint_surface_origin(constraint, &ox, &oy)) {
+		return;
+	}
+	double sx = cursor->cursor->x - ox;
+	double sy = cursor->cursor->y - oy;
+	if (!pixman_region32_contains_point(&constraint->region,
+				floor(sx), floor(sy), NULL)) {
+		int nboxes;
+		pixman_box32_t *boxes =
+			pixman_region32_rectangles(&constraint->region, &nboxes);
+		if (nboxes > 0) {
+			wlr_cursor_warp_closest(cursor->cursor, NULL,
+				ox + (boxes[0].x1 + boxes[0].x2) / 2.0,
+				oy + (boxes[0].y1 + boxes[0].y2) / 2.0);
+		}
+	}
+	cursor_send_pointer_motion(cursor, time_msec, false);
+}
+
+/**
+ * Move the cursor within the region of the active constraint. This doesn't hit
+ * test or change focus, the constrained surface keeps pointer focus.
+ */
+static void cursor_constrained_motion(struct sway_cursor *cursor,
+		struct wlr_input_device *device, uint32_t time_msec,
+		double dx, double dy) {
+	struct wlr_pointer_constraint_v1 *constraint = cursor->active_constraint;
+	struct wlr_seat *wlr_seat = cursor->seat->wlr_seat;
+	cursor_flush_motion(cursor);
+
+	double ox, oy;
+	if (!constraint_surface_origin(constraint, &ox, &oy)) {
+		return;
+	}
+	double sx = cursor->cursor->x - ox;
+	double sy = cursor->cursor->y - oy;
+	if (wlr_seat->pointer_state.focused_surface != constraint->surface ||
+			!pixman_region32_contains_point(&constraint->region,
+				floor(sx), floor(sy), NULL)) {
+		// The view moved, or the pointer hasn't entered it yet
+		cursor_warp_into_constraint(cursor, time_msec);
+		sx = cursor->cursor->x - ox;
+		sy = cursor->cursor->y - oy;
+	}
+
+	double sx_confined, sy_confined;
+	if (!wlr_region_confine(&cursor->confine, sx, sy, sx + dx, sy + dy,
+				&sx_confined, &sy_confined)) {
+		return;
+	}
+	wlr_cursor_move(cursor->cursor, device,
+		sx_confined - sx, sy_confined - sy);
+	if (!cursor_has_moved(cursor)) {
+		return;
+	}
+	// The cursor stays over the same container, so its hit remains valid
+	cursor->previous.x = cursor->cursor->x;
+	cursor->previous.y = cursor->cursor->y;
+	if (wlr_seat->pointer_state.focused_surface == constraint->surface) {
+		wlr_seat_pointer_notify_motion(wlr_seat, time_msec,
+			cursor->cursor->x - ox, cursor->cursor->y - oy);
+	}
+}
+
+/**
+ * Handle relative motion, which is also sent to clients using the relative
+ * pointer protocol.
+ */
+static void cursor_relative_motion(struct sway_cursor *cursor,
+		struct wlr_input_device *device, uint32_t time_msec,
+		double dx, double dy, double dx_unaccel, double dy_unaccel) {
+	wlr_relative_pointer_manager_v1_send_relative_motion(
+		server.relative_pointer_manager, cursor->seat->wlr_seat,
+		(uint64_t)time_msec * 1000, dx, dy, dx_unaccel, dy_unaccel);
+
+	if (cursor->active_constraint) {
+		cursor_constrained_motion(cursor, device, time_msec, dx, dy);
+		return;
+	}
+
+	wlr_cursor_move(cursor->cursor, device, dx, dy);
+	if (!cursor_has_moved(cursor)) {
+		return;
+	}
+	cursor_handle_motion(cursor, time_msec);
+}
+
 static void handle_cursor_motion(struct wl_listener *listener, void *data) {
 	struct sway_cursor *cursor = wl_container_of(listener, cursor, motion);
 	wlr_idle_notify_activity(cursor->seat->input->server->idle, cursor->seat->wlr_seat);
 	struct wlr_event_pointer_motion *event = data;
-	wlr_cursor_move(cursor->cursor, event->device,
-		event->delta_x, event->delta_y);
-	cursor_send_pointer_motion(cursor, event->time_msec, true);
-	transaction_commit_dirty();
+	latency_input_dispatched(LATENCY_MOTION, event->time_msec);
+	cursor_relative_motion(cursor, event->device, event->time_msec,
+		event->delta_x, event->delta_y, event->unaccel_dx, event->unaccel_dy);
 }
 
 static void handle_cursor_motion_absolute(
@@ -537,9 +884,14 @@ static void handle_cursor_motion_absolute(
 		wl_container_of(listener, cursor, motion_absolute);
 	wlr_idle_notify_activity(cursor->seat->input->server->idle, cursor->seat->wlr_seat);
 	struct wlr_event_pointer_motion_absolute *event = data;
-	wlr_cursor_warp_absolute(cursor->cursor, event->device, event->x, event->y);
-	cursor_send_pointer_motion(cursor, event->time_msec, true);
-	transaction_commit_dirty();
+	latency_input_dispatched(LATENCY_MOTION, event->time_msec);
+	double lx, ly;
+	wlr_cursor_absolute_to_layout_coords(cursor->cursor, event->device,
+		event->x, event->y, &lx, &ly);
+	double dx = lx - cursor->cursor->x;
+	double dy = ly - cursor->cursor->y;
+	cursor_relative_motion(cursor, event->device, event->time_msec,
+		dx, dy, dx, dy);
 }
 
 /**
@@ -626,6 +978,11 @@ void dispatch_cursor_button(struct sway_cursor *cursor,
 	}
 	struct sway_seat *seat = cursor->seat;
 
+	// Buttons act on the layout and position left by the keys and motion
+	// before them, and their bindings run after any bindings of those keys
+	execute_deferred_commands();
+	cursor_flush_motion(cursor);
+
 	// Handle ending seat operation
 	if (cursor->seat->operation != OP_NONE &&
 			button == cursor->seat->op_button && state == WLR_BUTTON_RELEASED) {
@@ -634,10 +991,12 @@ void dispatch_cursor_button(struct sway_cursor *cursor,
 		return;
 	}
 
-	// Determine what's under the cursor
+	// Determine what's under the cursor. The pointer's hit is for its previous
+	// position, which is where it is unless an operation moved it.
 	struct wlr_surface *surface = NULL;
 	double sx, sy;
-	struct sway_container *cont = container_at_coords(seat,
+	struct sway_container *cont = cursor_hit_test(cursor,
+			cursor_has_moved(cursor) ? NULL : &cursor->hit,
 			cursor->cursor->x, cursor->cursor->y, &surface, &sx, &sy);
 	bool is_floating = cont && container_is_floating(cont);
 	bool is_floating_or_child = cont && container_is_floating_or_child(cont);
@@ -782,6 +1141,7 @@ static void handle_cursor_button(struct wl_listener *listener, void *data) {
 	struct sway_cursor *cursor = wl_container_of(listener, cursor, button);
 	wlr_idle_notify_activity(cursor->seat->input->server->idle, cursor->seat->wlr_seat);
 	struct wlr_event_pointer_button *event = data;
+	latency_input_dispatched(LATENCY_BUTTON, event->time_msec);
 	dispatch_cursor_button(cursor,
 			event->time_msec, event->button, event->state);
 	transaction_commit_dirty();
@@ -791,14 +1151,54 @@ static void handle_cursor_axis(struct wl_listener *listener, void *data) {
 	struct sway_cursor *cursor = wl_container_of(listener, cursor, axis);
 	wlr_idle_notify_activity(cursor->seat->input->server->idle, cursor->seat->wlr_seat);
 	struct wlr_event_pointer_axis *event = data;
+	latency_input_dispatched(LATENCY_AXIS, event->time_msec);
+	execute_deferred_commands();
+	cursor_flush_motion(cursor);
 	wlr_seat_pointer_notify_axis(cursor->seat->wlr_seat, event->time_msec,
 		event->orientation, event->delta, event->delta_discrete, event->source);
+	transaction_commit_dirty();
+}
+
+/**
+ * Returns the hit of a touch point, or NULL if there are too many of them to
+ * keep track of.
+ */
+static struct sway_hit *touch_point_hit(struct sway_cursor *cursor,
+		int32_t touch_id) {
+	struct sway_touch_point *free_point = NULL;
+	for (size_t i = 0; i < SWAY_CURSOR_TOUCH_POINTS_CAP; ++i) {
+		struct sway_touch_point *point = &cursor->touch_points[i];
+		if (point->active && point->touch_id == touch_id) {
+			return &point->hit;
+		}
+		if (!point->active && !free_point) {
+			free_point = point;
+		}
+	}
+	if (!free_point) {
+		return NULL;
+	}
+	*free_point = (struct sway_touch_point){
+		.active = true,
+		.touch_id = touch_id,
+	};
+	return &free_point->hit;
+}
+
+static void touch_point_release(struct sway_cursor *cursor, int32_t touch_id) {
+	for (size_t i = 0; i < SWAY_CURSOR_TOUCH_POINTS_CAP; ++i) {
+		struct sway_touch_point *point = &cursor->touch_points[i];
+		if (point->active && point->touch_id == touch_id) {
+			point->active = false;
+		}
+	}
 }
 
 static void handle_touch_down(struct wl_listener *listener, void *data) {
 	struct sway_cursor *cursor = wl_container_of(listener, cursor, touch_down);
 	wlr_idle_notify_activity(cursor->seat->input->server->idle, cursor->seat->wlr_seat);
 	struct wlr_event_touch_down *event = data;
+	latency_input_dispatched(LATENCY_TOUCH, event->time_msec);
 
 	struct sway_seat *seat = cursor->seat;
 	struct wlr_seat *wlr_seat = seat->wlr_seat;
@@ -808,7 +1208,9 @@ static void handle_touch_down(struct wl_listener *listener, void *data) {
 	wlr_cursor_absolute_to_layout_coords(cursor->cursor, event->device,
 			event->x, event->y, &lx, &ly);
 	double sx, sy;
-	container_at_coords(seat, lx, ly, &surface, &sx, &sy);
+	touch_point_release(cursor, event->touch_id);
+	cursor_hit_test(cursor, touch_point_hit(cursor, event->touch_id),
+			lx, ly, &surface, &sx, &sy);
 
 	seat->touch_id = event->touch_id;
 	seat->touch_x = lx;
@@ -831,7 +1233,9 @@ static void handle_touch_up(struct wl_listener *listener, void *data) {
 	struct sway_cursor *cursor = wl_container_of(listener, cursor, touch_up);
 	wlr_idle_notify_activity(cursor->seat->input->server->idle, cursor->seat->wlr_seat);
 	struct wlr_event_touch_up *event = data;
+	latency_input_dispatched(LATENCY_TOUCH, event->time_msec);
 	struct wlr_seat *seat = cursor->seat->wlr_seat;
+	touch_point_release(cursor, event->touch_id);
 	// TODO: fall back to cursor simulation if client has not bound to touch
 	wlr_seat_touch_notify_up(seat, event->time_msec, event->touch_id);
 }
@@ -841,6 +1245,7 @@ static void handle_touch_motion(struct wl_listener *listener, void *data) {
 		wl_container_of(listener, cursor, touch_motion);
 	wlr_idle_notify_activity(cursor->seat->input->server->idle, cursor->seat->wlr_seat);
 	struct wlr_event_touch_motion *event = data;
+	latency_input_dispatched(LATENCY_TOUCH, event->time_msec);
 
 	struct sway_seat *seat = cursor->seat;
 	struct wlr_seat *wlr_seat = seat->wlr_seat;
@@ -850,7 +1255,8 @@ static void handle_touch_motion(struct wl_listener *listener, void *data) {
 	wlr_cursor_absolute_to_layout_coords(cursor->cursor, event->device,
 			event->x, event->y, &lx, &ly);
 	double sx, sy;
-	container_at_coords(cursor->seat, lx, ly, &surface, &sx, &sy);
+	cursor_hit_test(cursor, touch_point_hit(cursor, event->touch_id),
+			lx, ly, &surface, &sx, &sy);
 
 	if (seat->touch_id == event->touch_id) {
 		seat->touch_x = lx;
@@ -905,6 +1311,7 @@ static void handle_tool_axis(struct wl_listener *listener, void *data) {
 	struct sway_cursor *cursor = wl_container_of(listener, cursor, tool_axis);
 	wlr_idle_notify_activity(cursor->seat->input->server->idle, cursor->seat->wlr_seat);
 	struct wlr_event_tablet_tool_axis *event = data;
+	latency_input_dispatched(LATENCY_TABLET, event->time_msec);
 	struct sway_input_device *input_device = event->device->data;
 
 	double x = NAN, y = NAN;
@@ -920,15 +1327,28 @@ static void handle_tool_axis(struct wl_listener *listener, void *data) {
 		apply_mapping_from_region(event->device, ic->mapped_from_region, &x, &y);
 	}
 
+	if (cursor->active_constraint) {
+		// Move towards the tool's position, but stay inside the constraint
+		double lx, ly;
+		wlr_cursor_absolute_to_layout_coords(cursor->cursor, event->device,
+			x, y, &lx, &ly);
+		cursor_constrained_motion(cursor, event->device, event->time_msec,
+			lx - cursor->cursor->x, ly - cursor->cursor->y);
+		return;
+	}
+
 	wlr_cursor_warp_absolute(cursor->cursor, event->device, x, y);
-	cursor_send_pointer_motion(cursor, event->time_msec, true);
-	transaction_commit_dirty();
+	if (!cursor_has_moved(cursor)) {
+		return;
+	}
+	cursor_handle_motion(cursor, event->time_msec);
 }
 
 static void handle_tool_tip(struct wl_listener *listener, void *data) {
 	struct sway_cursor *cursor = wl_container_of(listener, cursor, tool_tip);
 	wlr_idle_notify_activity(cursor->seat->input->server->idle, cursor->seat->wlr_seat);
 	struct wlr_event_tablet_tool_tip *event = data;
+	latency_input_dispatched(LATENCY_TABLET, event->time_msec);
 	dispatch_cursor_button(cursor, event->time_msec,
 			BTN_LEFT, event->state == WLR_TABLET_TOOL_TIP_DOWN ?
 				WLR_BUTTON_PRESSED : WLR_BUTTON_RELEASED);
@@ -939,6 +1359,7 @@ static void handle_tool_button(struct wl_listener *listener, void *data) {
 	struct sway_cursor *cursor = wl_container_of(listener, cursor, tool_button);
 	wlr_idle_notify_activity(cursor->seat->input->server->idle, cursor->seat->wlr_seat);
 	struct wlr_event_tablet_tool_button *event = data;
+	latency_input_dispatched(LATENCY_TABLET, event->time_msec);
 	// TODO: the user may want to configure which tool buttons are mapped to
 	// which simulated pointer buttons
 	switch (event->state) {
@@ -991,7 +1412,10 @@ static void handle_request_set_cursor(struct wl_listener *listener,
 
 void cursor_set_image(struct sway_cursor *cursor, const char *image,
 		struct wl_client *client) {
-	if (!cursor->image || strcmp(cursor->image, image) != 0) {
+	// Image names are usually literals, so most calls are caught by the
+	// pointer comparison
+	if (cursor->image != image &&
+			(!cursor->image || strcmp(cursor->image, image) != 0)) {
 		wlr_xcursor_manager_set_cursor_image(cursor->xcursor_manager, image,
 				cursor->cursor);
 		cursor->image = image;
@@ -999,12 +1423,186 @@ void cursor_set_image(struct sway_cursor *cursor, const char *image,
 	cursor->image_client = client;
 }
 
+struct xcursor_manager_ref {
+	char *theme;
+	unsigned size;
+	struct wlr_xcursor_manager *manager;
+	int refs;
+};
+
+// Shared by all seats, so each theme is only loaded once per size and scale
+static list_t *xcursor_managers = NULL;
+
+struct wlr_xcursor_manager *xcursor_manager_get(const char *theme,
+		unsigned size) {
+	if (!xcursor_managers && !(xcursor_managers = create_list())) {
+		return NULL;
+	}
+	for (int i = 0; i < xcursor_managers->length; ++i) {
+		struct xcursor_manager_ref *ref = xcursor_managers->items[i];
+		if (ref->size == size && (ref->theme == theme ||
+				(ref->theme && theme && strcmp(ref->theme, theme) == 0))) {
+			ref->refs++;
+			return ref->manager;
+		}
+	}
+
+	struct xcursor_manager_ref *ref =
+		calloc(1, sizeof(struct xcursor_manager_ref));
+	if (!ref) {
+		return NULL;
+	}
+	ref->manager = wlr_xcursor_manager_create(theme, size);
+	if (!ref->manager) {
+		free(ref);
+		return NULL;
+	}
+	ref->theme = theme ? strdup(theme) : NULL;
+	ref->size = size;
+	ref->refs = 1;
+	list_add(xcursor_managers, ref);
+	return ref->manager;
+}
+
+void xcursor_manager_put(struct wlr_xcursor_manager *manager) {
+	if (!manager || !xcursor_managers) {
+		return;
+	}
+	for (int i = 0; i < xcursor_managers->length; ++i) {
+		struct xcursor_manager_ref *ref = xcursor_managers->items[i];
+		if (ref->manager != manager) {
+			continue;
+		}
+		if (--ref->refs == 0) {
+			wlr_xcursor_manager_destroy(ref->manager);
+			free(ref->theme);
+			free(ref);
+			list_del(xcursor_managers, i);
+		}
+		return;
+	}
+}
+
+struct sway_pointer_constraint {
+	struct wlr_pointer_constraint_v1 *constraint;
+	struct wl_listener destroy;
+};
+
+static void cursor_update_confine(struct sway_cursor *cursor) {
+	struct wlr_pointer_constraint_v1 *constraint = cursor->active_constraint;
+	// A locked pointer gets an empty region, which allows no motion at all
+	if (constraint->type == WLR_POINTER_CONSTRAINT_V1_CONFINED) {
+		pixman_region32_copy(&cursor->confine, &constraint->region);
+	} else {
+		pixman_region32_clear(&cursor->confine);
+	}
+}
+
+static void handle_constraint_commit(struct wl_listener *listener,
+		void *data) {
+	struct sway_cursor *cursor =
+		wl_container_of(listener, cursor, constraint_commit);
+	cursor_update_confine(cursor);
+}
+
+/**
+ * Move the cursor to where the client of a locked pointer hinted it to be.
+ */
+static void cursor_warp_to_constraint_hint(struct sway_cursor *cursor) {
+	struct wlr_pointer_constraint_v1 *constraint = cursor->active_constraint;
+	double ox, oy;
+	if (!(constraint->current.committed &
+				WLR_POINTER_CONSTRAINT_V1_STATE_CURSOR_HINT) ||
+			!constraint_surface_origin(constraint, &ox, &oy)) {
+		return;
+	}
+	wlr_cursor_warp(cursor->cursor, NULL,
+		ox + constraint->current.cursor_hint.x,
+		oy + constraint->current.cursor_hint.y);
+}
+
+void cursor_constrain(struct sway_cursor *cursor,
+		struct wlr_pointer_constraint_v1 *constraint) {
+	struct seat_config *seat_config = seat_get_config(cursor->seat);
+	if (constraint && seat_config &&
+			seat_config->pointer_constraint == POINTER_CONSTRAINT_DISABLE) {
+		constraint = NULL;
+	}
+	if (cursor->active_constraint == constraint) {
+		return;
+	}
+
+	wl_list_remove(&cursor->constraint_commit.link);
+	wl_list_init(&cursor->constraint_commit.link);
+	if (cursor->active_constraint) {
+		cursor_warp_to_constraint_hint(cursor);
+		wlr_pointer_constraint_v1_send_deactivated(cursor->active_constraint);
+	}
+
+	cursor->active_constraint = constraint;
+	if (!constraint) {
+		return;
+	}
+	cursor_update_confine(cursor);
+	cursor->constraint_commit.notify = handle_constraint_commit;
+	wl_signal_add(&constraint->surface->events.commit,
+		&cursor->constraint_commit);
+	wlr_pointer_constraint_v1_send_activated(constraint);
+	cursor_warp_into_constraint(cursor, 0);
+}
+
+static void handle_constraint_destroy(struct wl_listener *listener,
+		void *data) {
+	struct sway_pointer_constraint *sway_constraint =
+		wl_container_of(listener, sway_constraint, destroy);
+	struct wlr_pointer_constraint_v1 *constraint = sway_constraint->constraint;
+	struct sway_seat *seat = constraint->seat->data;
+	struct sway_cursor *cursor = seat->cursor;
+
+	// The cursor is destroyed before the seat, which destroys its constraints
+	if (cursor && cursor->active_constraint == constraint) {
+		cursor_warp_to_constraint_hint(cursor);
+		wl_list_remove(&cursor->constraint_commit.link);
+		wl_list_init(&cursor->constraint_commit.link);
+		cursor->active_constraint = NULL;
+	}
+
+	wl_list_remove(&sway_constraint->destroy.link);
+	free(sway_constraint);
+}
+
+void handle_pointer_constraint(struct wl_listener *listener, void *data) {
+	struct wlr_pointer_constraint_v1 *constraint = data;
+	struct sway_seat *seat = constraint->seat->data;
+
+	struct sway_pointer_constraint *sway_constraint =
+		calloc(1, sizeof(struct sway_pointer_constraint));
+	if (!sway_assert(sway_constraint, "could not allocate pointer constraint")) {
+		return;
+	}
+	sway_constraint->constraint = constraint;
+	wl_signal_add(&constraint->events.destroy, &sway_constraint->destroy);
+	sway_constraint->destroy.notify = handle_constraint_destroy;
+
+	struct sway_container *focus = seat_get_focus(seat);
+	if (focus && focus->type == C_VIEW &&
+			focus->sway_view->surface == constraint->surface) {
+		cursor_constrain(seat->cursor, constraint);
+	}
+}
+
 void sway_cursor_destroy(struct sway_cursor *cursor) {
 	if (!cursor) {
 		return;
 	}
 
-	wlr_xcursor_manager_destroy(cursor->xcursor_manager);
+	wl_list_remove(&cursor->constraint_commit.link);
+	pixman_region32_fini(&cursor->confine);
+
+	if (cursor->motion_timer) {
+		wl_event_source_remove(cursor->motion_timer);
+	}
+	xcursor_manager_put(cursor->xcursor_manager);
 	wlr_cursor_destroy(cursor->cursor);
 	free(cursor);
 }
@@ -1069,6 +1667,9 @@ struct sway_cursor *sway_cursor_create(struct sway_seat *seat) {
 			&cursor->request_set_cursor);
 	cursor->request_set_cursor.notify = handle_request_set_cursor;
 
+	wl_list_init(&cursor->constraint_commit.link);
+	pixman_region32_init(&cursor->confine);
+
 	cursor->cursor = wlr_cursor;
 
 	return cursor;
@@ -1,16 +1,36 @@
 #include <assert.h>
 #include <limits.h>
+#include <stdlib.h>
+#include <string.h>
 #include <wlr/backend/multi.h>
 #include <wlr/backend/session.h>
 #include <wlr/types/wlr_idle.h>
 #include <wlr/interfaces/wlr_keyboard.h>
 #include "sway/commands.h"
 #include "sway/desktop/transaction.h"
+#include "sway/input/cursor.h"
 #include "sway/input/input-manager.h"
 #include "sway/input/keyboard.h"
+#include "sway/input/latency.h"
 #include "sway/input/seat.h"
+#include "hash_table.h"
+#include "list.h"
 #include "log.h"
 
+// Keymaps which aren't used by any keyboard are kept up to this number, so
+// devices which are plugged in again don't need to compile theirs again
+#define KEYMAP_CACHE_UNUSED_MAX 8
+
+struct keymap_cache_entry {
+	char *key;
+	size_t key_len;
+	struct xkb_keymap *keymap;
+	int users;
+};
+
+static struct xkb_context *keymap_context = NULL;
+static hash_table_t *keymap_cache = NULL;
+
 /**
  * Remove all key ids associated to a keycode from the list of pressed keys
  */
@@ -85,40 +105,24 @@ static void update_shortcut_state(struct sway_shortcut_state *state,
  * current modifiers, release state, and locked state.
  */
 static void get_active_binding(const struct sway_shortcut_state *state,
-		list_t *bindings, struct sway_binding **current_binding,
+		enum binding_input_type type, struct sway_binding **current_binding,
 		uint32_t modifiers, bool release, bool locked) {
-	for (int i = 0; i < bindings->length; ++i) {
-		struct sway_binding *binding = bindings->items[i];
-		bool binding_locked = binding->flags & BINDING_LOCKED;
-		bool binding_release = binding->flags & BINDING_RELEASE;
-
-		if (modifiers ^ binding->modifiers ||
-				state->npressed != (size_t)binding->keys->length ||
-				release != binding_release ||
-				locked > binding_locked) {
-			continue;
-		}
-
-		bool match = true;
-		for (size_t j = 0; j < state->npressed; j++) {
-			uint32_t key = *(uint32_t *)binding->keys->items[j];
-			if (key != state->pressed_keys[j]) {
-				match = false;
-				break;
-			}
-		}
-		if (!match) {
-			continue;
-		}
-
-		if (*current_binding && *current_binding != binding) {
-			wlr_log(WLR_DEBUG, "encountered duplicate bindings %d and %d",
-					(*current_binding)->order, binding->order);
-		} else {
-			*current_binding = binding;
-		}
+	struct sway_binding *binding = mode_find_binding(config->current_mode,
+			type, modifiers, release, state->pressed_keys, state->npressed);
+	if (!binding) {
+		return;
+	}
+	bool binding_locked = binding->flags & BINDING_LOCKED;
+	if (locked > binding_locked) {
 		return;
 	}
+
+	if (*current_binding && *current_binding != binding) {
+		wlr_log(WLR_DEBUG, "encountered duplicate bindings %d and %d",
+				(*current_binding)->order, binding->order);
+	} else {
+		*current_binding = binding;
+	}
 }
 
 /**
@@ -203,6 +207,9 @@ static void handle_keyboard_key(struct wl_listener *listener, void *data) {
 		keyboard->seat_device->input_device->wlr_device;
 	wlr_idle_notify_activity(seat->input->server->idle, wlr_seat);
 	struct wlr_event_keyboard_key *event = data;
+	latency_input_dispatched(LATENCY_KEY, event->time_msec);
+	// Focus follows the mouse, so held back motion must be handled first
+	cursor_flush_motion(seat->cursor);
 	bool input_inhibited = seat->exclusive_client != NULL;
 
 	// Identify new keycode, raw keysym(s), and translated keysym(s)
@@ -241,19 +248,19 @@ static void handle_keyboard_key(struct wl_listener *listener, void *data) {
 	// Identify active release binding
 	struct sway_binding *binding_released = NULL;
 	get_active_binding(&keyboard->state_keycodes,
-			config->current_mode->keycode_bindings, &binding_released,
+			BINDING_KEYCODE, &binding_released,
 			code_modifiers, true, input_inhibited);
 	get_active_binding(&keyboard->state_keysyms_translated,
-			config->current_mode->keysym_bindings, &binding_released,
+			BINDING_KEYSYM, &binding_released,
 			translated_modifiers, true, input_inhibited);
 	get_active_binding(&keyboard->state_keysyms_raw,
-			config->current_mode->keysym_bindings, &binding_released,
+			BINDING_KEYSYM, &binding_released,
 			raw_modifiers, true, input_inhibited);
 
 	// Execute stored release binding once no longer active
 	if (keyboard->held_binding && binding_released != keyboard->held_binding &&
 			event->state == WLR_KEY_RELEASED) {
-		seat_execute_command(seat, keyboard->held_binding);
+		seat_execute_command_deferred(seat, keyboard->held_binding);
 		handled = true;
 	}
 	if (binding_released != keyboard->held_binding) {
@@ -268,17 +275,17 @@ static void handle_keyboard_key(struct wl_listener *listener, void *data) {
 	if (event->state == WLR_KEY_PRESSED) {
 		struct sway_binding *binding_pressed = NULL;
 		get_active_binding(&keyboard->state_keycodes,
-				config->current_mode->keycode_bindings, &binding_pressed,
+				BINDING_KEYCODE, &binding_pressed,
 				code_modifiers, false, input_inhibited);
 		get_active_binding(&keyboard->state_keysyms_translated,
-				config->current_mode->keysym_bindings, &binding_pressed,
+				BINDING_KEYSYM, &binding_pressed,
 				translated_modifiers, false, input_inhibited);
 		get_active_binding(&keyboard->state_keysyms_raw,
-				config->current_mode->keysym_bindings, &binding_pressed,
+				BINDING_KEYSYM, &binding_pressed,
 				raw_modifiers, false, input_inhibited);
 
 		if (binding_pressed) {
-			seat_execute_command(seat, binding_pressed);
+			seat_execute_command_deferred(seat, binding_pressed);
 			handled = true;
 			next_repeat_binding = binding_pressed;
 		}
@@ -311,6 +318,13 @@ static void handle_keyboard_key(struct wl_listener *listener, void *data) {
 	}
 
 	if (!handled || event->state == WLR_KEY_RELEASED) {
+		if (event->state == WLR_KEY_PRESSED) {
+			// A binding such as `focus left` followed by typing must deliver
+			// the typed key to the newly focused client, so the bindings
+			// pressed before it run first. Releases don't need this, as
+			// clients ignore releases of keys they didn't see pressed.
+			execute_deferred_commands();
+		}
 		wlr_seat_set_keyboard(wlr_seat, wlr_device);
 		wlr_seat_keyboard_notify_key(wlr_seat, event->time_msec,
 				event->keycode, event->state);
@@ -332,9 +346,8 @@ static int handle_keyboard_repeat(void *data) {
 			}
 		}
 
-		seat_execute_command(keyboard->seat_device->sway_seat,
+		seat_execute_command_deferred(keyboard->seat_device->sway_seat,
 				keyboard->repeat_binding);
-		transaction_commit_dirty();
 	}
 	return 0;
 }
@@ -370,6 +383,137 @@ struct sway_keyboard *sway_keyboard_create(struct sway_seat *seat,
 	return keyboard;
 }
 
+/**
+ * Build the cache key of a set of rule names. Unset names are the same as empty
+ * ones to xkbcommon.
+ */
+static char *keymap_cache_key(const struct xkb_rule_names *rules,
+		size_t *key_len) {
+	const char *names[] = {
+		rules->rules, rules->model, rules->layout, rules->variant,
+		rules->options,
+	};
+	size_t len = 0;
+	for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+		len += (names[i] ? strlen(names[i]) : 0) + 1;
+	}
+	char *key = malloc(len);
+	if (!key) {
+		return NULL;
+	}
+	char *p = key;
+	for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+		size_t name_len = names[i] ? strlen(names[i]) : 0;
+		memcpy(p, names[i] ? names[i] : "", name_len);
+		p[name_len] = '\0';
+		p += name_len + 1;
+	}
+	*key_len = len;
+	return key;
+}
+
+static void keymap_cache_entry_destroy(struct keymap_cache_entry *entry) {
+	hash_table_remove(keymap_cache, entry->key, entry->key_len);
+	xkb_keymap_unref(entry->keymap);
+	free(entry->key);
+	free(entry);
+}
+
+struct keymap_cache_search {
+	struct xkb_keymap *keymap;
+	struct keymap_cache_entry *entry;
+	list_t *unused;
+};
+
+static void keymap_cache_search_iterator(const void *key, size_t key_len,
+		void *value, void *data) {
+	struct keymap_cache_entry *entry = value;
+	struct keymap_cache_search *search = data;
+	if (search->keymap && entry->keymap == search->keymap) {
+		search->entry = entry;
+	}
+	if (search->unused && entry->users == 0) {
+		list_add(search->unused, entry);
+	}
+}
+
+static void keymap_cache_prune(void) {
+	struct keymap_cache_search search = { .unused = create_list() };
+	hash_table_foreach(keymap_cache, keymap_cache_search_iterator, &search);
+	if (search.unused->length > KEYMAP_CACHE_UNUSED_MAX) {
+		for (int i = 0; i < search.unused->length; ++i) {
+			keymap_cache_entry_destroy(search.unused->items[i]);
+		}
+	}
+	list_free(search.unused);
+}
+
+/**
+ * Get the compiled keymap for a set of rule names, compiling it if no keyboard
+ * used the same names before. Each call must be paired with a call to
+ * keymap_cache_release.
+ */
+static struct xkb_keymap *keymap_cache_get(const struct xkb_rule_names *rules) {
+	if (!keymap_context) {
+		keymap_context = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
+		if (!sway_assert(keymap_context, "cannot create XKB context")) {
+			return NULL;
+		}
+	}
+	if (!keymap_cache && !(keymap_cache = create_hash_table())) {
+		return NULL;
+	}
+
+	size_t key_len;
+	char *key = keymap_cache_key(rules, &key_len);
+	if (!key) {
+		return NULL;
+	}
+	struct keymap_cache_entry *entry =
+		hash_table_get(keymap_cache, key, key_len);
+	if (entry) {
+		free(key);
+		entry->users++;
+		return entry->keymap;
+	}
+
+	struct xkb_keymap *keymap = xkb_keymap_new_from_names(keymap_context,
+			rules, XKB_KEYMAP_COMPILE_NO_FLAGS);
+	if (!keymap) {
+		free(key);
+		return NULL;
+	}
+	entry = calloc(1, sizeof(struct keymap_cache_entry));
+	if (!entry || !hash_table_set(keymap_cache, key, key_len, entry)) {
+		wlr_log(WLR_ERROR, "Unable to cache keymap");
+		free(entry);
+		free(key);
+		// The keymap is still usable, the caller's reference is the only one
+		return keymap;
+	}
+	entry->key = key;
+	entry->key_len = key_len;
+	entry->keymap = keymap;
+	entry->users = 1;
+	keymap_cache_prune();
+	return keymap;
+}
+
+static void keymap_cache_release(struct xkb_keymap *keymap) {
+	if (!keymap) {
+		return;
+	}
+	struct keymap_cache_search search = { .keymap = keymap };
+	if (keymap_cache) {
+		hash_table_foreach(keymap_cache, keymap_cache_search_iterator, &search);
+	}
+	if (search.entry) {
+		search.entry->users--;
+	} else {
+		xkb_keymap_unref(keymap);
+	}
+}
+
 void sway_keyboard_configure(struct sway_keyboard *keyboard) {
 	struct xkb_rule_names rules;
 	memset(&rules, 0, sizeof(rules));
@@ -407,23 +551,19 @@ void sway_keyboard_configure(struct sway_keyboard *keyboard) {
 		rules.variant = getenv("XKB_DEFAULT_VARIANT");
 	}
 
-	struct xkb_context *context = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
-	if (!sway_assert(context, "cannot create XKB context")) {
-		return;
-	}
-
-	struct xkb_keymap *keymap =
-		xkb_keymap_new_from_names(context, &rules, XKB_KEYMAP_COMPILE_NO_FLAGS);
-
+	struct xkb_keymap *keymap = keymap_cache_get(&rules);
 	if (!keymap) {
 		wlr_log(WLR_DEBUG, "cannot configure keyboard: keymap does not exist");
-		xkb_context_unref(context);
 		return;
 	}
 
-	xkb_keymap_unref(keyboard->keymap);
+	keymap_cache_release(keyboard->keymap);
 	keyboard->keymap = keymap;
-	wlr_keyboard_set_keymap(wlr_device->keyboard, keyboard->keymap);
+	// Setting the keymap sends it to every client again, which isn't needed
+	// if it's the same one
+	if (wlr_device->keyboard->keymap != keymap) {
+		wlr_keyboard_set_keymap(wlr_device->keyboard, keyboard->keymap);
+	}
 
 	xkb_mod_mask_t locked_mods = 0;
 	if (input_config && input_config->xkb_numlock > 0) {
@@ -457,7 +597,6 @@ void sway_keyboard_configure(struct sway_keyboard *keyboard) {
 	} else {
 		wlr_keyboard_set_repeat_info(wlr_device->keyboard, 25, 600);
 	}
-	xkb_context_unref(context);
 	struct wlr_seat *seat = keyboard->seat_device->sway_seat->wlr_seat;
 	wlr_seat_set_keyboard(seat, wlr_device);
 
@@ -475,9 +614,7 @@ void sway_keyboard_destroy(struct sway_keyboard *keyboard) {
 	if (!keyboard) {
 		return;
 	}
-	if (keyboard->keymap) {
-		xkb_keymap_unref(keyboard->keymap);
-	}
+	keymap_cache_release(keyboard->keymap);
 	wl_list_remove(&keyboard->keyboard_key.link);
 	wl_list_remove(&keyboard->keyboard_modifiers.link);
 	wl_event_source_remove(keyboard->key_repeat_source);
@@ -0,0 +1,202 @@
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <wlr/util/log.h>
+#include "sway/debug.h"
+#include "sway/input/latency.h"
+
+// Events whose effect hasn't been presented after this long are assumed to
+// have had no visible effect, and are dropped when the next one comes in
+#define LATENCY_EXPIRE_NSEC 1000000000ULL
+
+// Device timestamps further in the past than this aren't CLOCK_MONOTONIC
+#define LATENCY_INPUT_MAX_MSEC 10000
+
+enum latency_record_state {
+	RECORD_NONE,
+	RECORD_DISPATCHED, // waiting for damage
+	RECORD_DAMAGED, // waiting for a commit of output
+	RECORD_COMMITTED, // waiting for output to present
+};
+
+struct latency_record {
+	enum latency_record_state state;
+	// Only compared, never dereferenced, as the output may be destroyed
+	struct sway_output *output;
+	uint32_t input_msec;
+	uint64_t dispatch_nsec;
+	uint64_t commit_nsec;
+};
+
+static struct latency_record records[LATENCY_EVENT_TYPE_COUNT];
+static struct latency_stats stats[LATENCY_EVENT_TYPE_COUNT][LATENCY_STAGE_COUNT];
+static FILE *trace_file = NULL;
+
+static uint64_t get_current_time_nsec(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static void stats_add(enum latency_event_type type, enum latency_stage stage,
+		uint64_t nsec) {
+	struct latency_stats *s = &stats[type][stage];
+	uint64_t us = nsec / 1000;
+	size_t bucket = 0;
+	while (bucket < LATENCY_HISTOGRAM_BUCKETS - 1 && us >= 1ULL << bucket) {
+		++bucket;
+	}
+	++s->count;
+	s->sum_us += us;
+	if (us > s->max_us) {
+		s->max_us = us;
+	}
+	++s->histogram[bucket];
+}
+
+void latency_init(void) {
+	if (!debug.input_trace) {
+		return;
+	}
+	trace_file = fopen(debug.input_trace, "wb");
+	if (!trace_file) {
+		wlr_log(WLR_ERROR, "Unable to open input trace file %s: %s",
+				debug.input_trace, strerror(errno));
+		return;
+	}
+	fwrite("SWAYLAT1", 1, 8, trace_file);
+}
+
+void latency_finish(void) {
+	if (trace_file) {
+		fclose(trace_file);
+		trace_file = NULL;
+	}
+}
+
+void latency_input_dispatched(enum latency_event_type type,
+		uint32_t time_msec) {
+	if (!debug.input_latency) {
+		return;
+	}
+	uint64_t now = get_current_time_nsec();
+	struct latency_record *record = &records[type];
+	if (record->state != RECORD_NONE &&
+			now - record->dispatch_nsec < LATENCY_EXPIRE_NSEC) {
+		// Keep following the oldest event
+		return;
+	}
+
+	// Unsigned arithmetic copes with the millisecond clock wrapping
+	uint32_t input_msec = (uint32_t)(now / 1000000) - time_msec;
+	if (input_msec < LATENCY_INPUT_MAX_MSEC) {
+		stats_add(type, LATENCY_STAGE_INPUT, (uint64_t)input_msec * 1000000);
+	}
+
+	*record = (struct latency_record){
+		.state = RECORD_DISPATCHED,
+		.input_msec = time_msec,
+		.dispatch_nsec = now,
+	};
+}
+
+void latency_damage(struct sway_output *output) {
+	if (!debug.input_latency) {
+		return;
+	}
+	for (size_t i = 0; i < LATENCY_EVENT_TYPE_COUNT; ++i) {
+		if (records[i].state == RECORD_DISPATCHED) {
+			records[i].state = RECORD_DAMAGED;
+			records[i].output = output;
+		}
+	}
+}
+
+void latency_output_commit(struct sway_output *output) {
+	if (!debug.input_latency) {
+		return;
+	}
+	uint64_t now = 0;
+	for (size_t i = 0; i < LATENCY_EVENT_TYPE_COUNT; ++i) {
+		struct latency_record *record = &records[i];
+		if (record->state != RECORD_DAMAGED || record->output != output) {
+			continue;
+		}
+		if (!now) {
+			now = get_current_time_nsec();
+		}
+		record->state = RECORD_COMMITTED;
+		record->commit_nsec = now;
+		stats_add(i, LATENCY_STAGE_DISPATCH, now - record->dispatch_nsec);
+	}
+}
+
+void latency_output_present(struct sway_output *output) {
+	if (!debug.input_latency) {
+		return;
+	}
+	uint64_t now = 0;
+	for (size_t i = 0; i < LATENCY_EVENT_TYPE_COUNT; ++i) {
+		struct latency_record *record = &records[i];
+		if (record->state != RECORD_COMMITTED || record->output != output) {
+			continue;
+		}
+		if (!now) {
+			now = get_current_time_nsec();
+		}
+		stats_add(i, LATENCY_STAGE_COMMIT, now - record->commit_nsec);
+		if (trace_file) {
+			struct latency_trace_record trace = {
+				.type = i,
+				.input_msec = record->input_msec,
+				.dispatch_nsec = record->dispatch_nsec,
+				.commit_nsec = record->commit_nsec,
+				.present_nsec = now,
+			};
+			fwrite(&trace, sizeof(trace), 1, trace_file);
+		}
+		record->state = RECORD_NONE;
+	}
+}
+
+const char *latency_event_type_name(enum latency_event_type type) {
+	switch (type) {
+	case LATENCY_KEY:
+		return "key";
+	case LATENCY_BUTTON:
+		return "button";
+	case LATENCY_MOTION:
+		return "motion";
+	case LATENCY_AXIS:
+		return "axis";
+	case LATENCY_TOUCH:
+		return "touch";
+	case LATENCY_TABLET:
+		return "tablet";
+	case LATENCY_EVENT_TYPE_COUNT:
+		break;
+	}
+	return "unknown";
+}
+
+const char *latency_stage_name(enum latency_stage stage) {
+	switch (stage) {
+	case LATENCY_STAGE_INPUT:
+		return "input_to_dispatch";
+	case LATENCY_STAGE_DISPATCH:
+		return "dispatch_to_commit";
+	case LATENCY_STAGE_COMMIT:
+		return "commit_to_present";
+	case LATENCY_STAGE_COUNT:
+		break;
+	}
+	return "unknown";
+}
+
+const struct latency_stats *latency_get_stats(enum latency_event_type type,
+		enum latency_stage stage) {
+	return &stats[type][stage];
+}
@@ -2,6 +2,7 @@
 #define _POSIX_C_SOURCE 199309L
 #include <assert.h>
 #include <errno.h>
+#include <stdlib.h>
 #ifdef __linux__
 #include <linux/input-event-codes.h>
 #elif __FreeBSD__
@@ -42,11 +43,13 @@ static void seat_device_destroy(struct sway_seat_device *seat_device) {
 }
 
 void seat_destroy(struct sway_seat *seat) {
+	seat_cancel_deferred_commands(seat);
 	struct sway_seat_device *seat_device, *next;
 	wl_list_for_each_safe(seat_device, next, &seat->devices, link) {
 		seat_device_destroy(seat_device);
 	}
 	sway_cursor_destroy(seat->cursor);
+	seat->cursor = NULL;
 	wl_list_remove(&seat->new_container.link);
 	wl_list_remove(&seat->new_drag_icon.link);
 	wl_list_remove(&seat->link);
@@ -120,6 +123,12 @@ static void seat_send_focus(struct sway_container *con,
 			wlr_seat_keyboard_notify_enter(
 					seat->wlr_seat, con->sway_view->surface, NULL, 0, NULL);
 		}
+
+		struct wlr_pointer_constraint_v1 *constraint =
+			wlr_pointer_constraints_v1_constraint_for_surface(
+				server.pointer_constraints, con->sway_view->surface,
+				seat->wlr_seat);
+		cursor_constrain(seat->cursor, constraint);
 	}
 }
 
@@ -526,19 +535,32 @@ void seat_remove_device(struct sway_seat *seat,
 }
 
 void seat_configure_xcursor(struct sway_seat *seat) {
-	// TODO configure theme and size
-	const char *cursor_theme = NULL;
+	const char *cursor_theme = getenv("SWAY_CURSOR_THEME");
+	unsigned cursor_size = 24;
+	const char *size_env = getenv("SWAY_CURSOR_SIZE");
+	if (size_env) {
+		char *end;
+		unsigned long size = strtoul(size_env, &end, 10);
+		if (*end == '\0' && size > 0) {
+			cursor_size = size;
+		}
+	}
 
 	if (!seat->cursor->xcursor_manager) {
 		seat->cursor->xcursor_manager =
-			wlr_xcursor_manager_create(cursor_theme, 24);
-		if (sway_assert(seat->cursor->xcursor_manager,
+			xcursor_manager_get(cursor_theme, cursor_size);
+		if (!sway_assert(seat->cursor->xcursor_manager,
 					"Cannot create XCursor manager for theme %s",
 					cursor_theme)) {
 			return;
 		}
 	}
 
+	// Every output's scale is loaded up front rather than when the cursor
+	// first enters an output: wlr_cursor sets the image on all outputs at
+	// once, and only from the scales loaded at that time. Loading a scale
+	// the shared manager already has is a no-op, so each (theme, size,
+	// scale) is still only read once, for scales an output actually uses.
 	for (int i = 0; i < root_container.children->length; ++i) {
 		struct sway_container *output_container =
 			root_container.children->items[i];
@@ -554,8 +576,9 @@ void seat_configure_xcursor(struct sway_seat *seat) {
 			output->name, (double)output->scale);
 	}
 
-	wlr_xcursor_manager_set_cursor_image(seat->cursor->xcursor_manager,
-		"left_ptr", seat->cursor->cursor);
+	// Set the image again, so outputs which were added get it too
+	seat->cursor->image = NULL;
+	cursor_set_image(seat->cursor, "left_ptr", seat->cursor->image_client);
 	wlr_cursor_warp(seat->cursor->cursor, NULL, seat->cursor->cursor->x,
 		seat->cursor->cursor->y);
 }
@@ -572,6 +595,7 @@ static void seat_send_unfocus(struct sway_container *container,
 	if (container->type == C_VIEW) {
 		wlr_seat_keyboard_clear_focus(seat->wlr_seat);
 		view_set_activated(container->sway_view, false);
+		cursor_constrain(seat->cursor, NULL);
 	} else {
 		for (int i = 0; i < container->children->length; ++i) {
 			struct sway_container *child = container->children->items[i];
@@ -923,6 +947,10 @@ void seat_apply_config(struct sway_seat *seat,
 	wl_list_for_each(seat_device, &seat->devices, link) {
 		seat_configure_device(seat, seat_device->input_device);
 	}
+
+	if (seat_config->pointer_constraint == POINTER_CONSTRAINT_DISABLE) {
+		cursor_constrain(seat->cursor, NULL);
+	}
 }
 
 struct seat_config *seat_get_config(struct sway_seat *seat) {
@@ -1008,6 +1036,10 @@ void seat_end_mouse_operation(struct sway_seat *seat) {
 		// output again.
 		struct sway_container *con = seat->op_container;
 		container_floating_move_to(con, con->x, con->y);
+	} else if (seat->operation == OP_RESIZE_FLOATING ||
+			seat->operation == OP_RESIZE_TILING) {
+		// Remove the outline of the new size
+		desktop_damage_resize_outline(seat->op_container);
 	}
 	seat->operation = OP_NONE;
 	seat->op_container = NULL;
@@ -1018,6 +1050,7 @@ void seat_end_mouse_operation(struct sway_seat *seat) {
 		// during the operation.
 		seat->cursor->previous.x = seat->op_ref_lx;
 		seat->cursor->previous.y = seat->op_ref_ly;
+		seat->cursor->hit.valid = false;
 		if (seat->op_moved) {
 			cursor_send_pointer_motion(seat->cursor, 0, true);
 		}
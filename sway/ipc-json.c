@@ -8,7 +8,9 @@
 #include "sway/tree/view.h"
 #include "sway/tree/workspace.h"
 #include "sway/output.h"
+#include "sway/debug.h"
 #include "sway/input/input-manager.h"
+#include "sway/input/latency.h"
 #include "sway/input/seat.h"
 #include <wlr/types/wlr_box.h>
 #include <wlr/types/wlr_output.h>
@@ -139,6 +141,16 @@ static void ipc_json_describe_output(struct sway_container *container,
 
 	json_object_object_add(object, "modes", modes_array);
 	json_object_object_add(object, "layout", json_object_new_string("output"));
+
+	struct sway_output *output = container->sway_output;
+	json_object *frame_stats = json_object_new_object();
+	json_object_object_add(frame_stats, "hardware_cursor",
+			json_object_new_boolean(wlr_output->hardware_cursor != NULL));
+	json_object_object_add(frame_stats, "frames",
+			json_object_new_int64(output->frame_stats.frames));
+	json_object_object_add(frame_stats, "composited",
+			json_object_new_int64(output->frame_stats.composited));
+	json_object_object_add(object, "frame_stats", frame_stats);
 }
 
 json_object *ipc_json_describe_disabled_output(struct sway_output *output) {
@@ -348,6 +360,44 @@ json_object *ipc_json_describe_seat(struct sway_seat *seat) {
 	return object;
 }
 
+json_object *ipc_json_describe_input_latency(void) {
+	json_object *object = json_object_new_object();
+	json_object_object_add(object, "enabled",
+		json_object_new_boolean(debug.input_latency));
+
+	json_object *events = json_object_new_object();
+	for (int type = 0; type < LATENCY_EVENT_TYPE_COUNT; ++type) {
+		json_object *stages = json_object_new_object();
+		for (int stage = 0; stage < LATENCY_STAGE_COUNT; ++stage) {
+			const struct latency_stats *stats =
+				latency_get_stats(type, stage);
+			json_object *stats_object = json_object_new_object();
+			json_object_object_add(stats_object, "count",
+				json_object_new_int64(stats->count));
+			json_object_object_add(stats_object, "avg_us",
+				json_object_new_int64(stats->count ?
+					stats->sum_us / stats->count : 0));
+			json_object_object_add(stats_object, "max_us",
+				json_object_new_int64(stats->max_us));
+
+			// Counts of latencies below 1, 2, 4, ... microseconds
+			json_object *histogram = json_object_new_array();
+			for (int i = 0; i < LATENCY_HISTOGRAM_BUCKETS; ++i) {
+				json_object_array_add(histogram,
+					json_object_new_int64(stats->histogram[i]));
+			}
+			json_object_object_add(stats_object, "histogram", histogram);
+
+			json_object_object_add(stages, latency_stage_name(stage),
+				stats_object);
+		}
+		json_object_object_add(events, latency_event_type_name(type), stages);
+	}
+	json_object_object_add(object, "events", events);
+
+	return object;
+}
+
 json_object *ipc_json_describe_bar_config(struct bar_config *bar) {
 	if (!sway_assert(bar, "Bar must not be NULL")) {
 		return NULL;
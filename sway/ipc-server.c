@@ -550,14 +550,15 @@ static void ipc_get_workspaces_callback(struct sway_container *workspace,
 			json_object_new_boolean(visible));
 }
 
-static void ipc_get_marks_callback(struct sway_container *con, void *data) {
-	json_object *marks = (json_object *)data;
-	if (con->type == C_VIEW && con->sway_view->marks) {
-		for (int i = 0; i < con->sway_view->marks->length; ++i) {
-			char *mark = (char *)con->sway_view->marks->items[i];
-			json_object_array_add(marks, json_object_new_string(mark));
-		}
+static void ipc_get_marks_callback(const void *key, size_t key_len,
+		void *value, void *data) {
+	struct sway_view *view = value;
+	if (!view->swayc || view->swayc->destroying) {
+		// Unmapped views keep their marks, but aren't in the tree
+		return;
 	}
+	json_object *marks = (json_object *)data;
+	json_object_array_add(marks, json_object_new_string_len(key, key_len));
 }
 
 void ipc_client_handle_command(struct ipc_client *client) {
@@ -715,6 +716,16 @@ void ipc_client_handle_command(struct ipc_client *client) {
 		goto exit_cleanup;
 	}
 
+	case IPC_GET_INPUT_LATENCY:
+	{
+		json_object *latency = ipc_json_describe_input_latency();
+		const char *json_string = json_object_to_json_string(latency);
+		client_valid =
+			ipc_send_reply(client, json_string, (uint32_t)strlen(json_string));
+		json_object_put(latency); // free
+		goto exit_cleanup;
+	}
+
 	case IPC_GET_TREE:
 	{
 		json_object *tree =
@@ -729,7 +740,8 @@ void ipc_client_handle_command(struct ipc_client *client) {
 	case IPC_GET_MARKS:
 	{
 		json_object *marks = json_object_new_array();
-		root_for_each_container(ipc_get_marks_callback, marks);
+		hash_table_foreach(root_container.sway_root->views_by_mark,
+				ipc_get_marks_callback, marks);
 		const char *json_string = json_object_to_json_string(marks);
 		client_valid =
 			ipc_send_reply(client, json_string, (uint32_t)strlen(json_string));
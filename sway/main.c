@@ -21,6 +21,7 @@
 #include "sway/config.h"
 #include "sway/debug.h"
 #include "sway/desktop/transaction.h"
+#include "sway/input/latency.h"
 #include "sway/server.h"
 #include "sway/swaynag.h"
 #include "sway/tree/root.h"
@@ -249,16 +250,22 @@ void enable_debug_flag(const char *flag) {
 		debug.txn_timings = true;
 	} else if (strncmp(flag, "txn-timeout=", 12) == 0) {
 		server.txn_timeout_ms = atoi(&flag[12]);
+	} else if (strcmp(flag, "input-latency") == 0) {
+		debug.input_latency = true;
+	} else if (strncmp(flag, "input-trace=", 12) == 0) {
+		debug.input_latency = true;
+		debug.input_trace = &flag[12];
 	}
 }
 
 int main(int argc, char **argv) {
-	static int verbose = 0, debug = 0, validate = 0;
+	static int verbose = 0, debug = 0, validate = 0, profile = 0;
 
 	static struct option long_options[] = {
 		{"help", no_argument, NULL, 'h'},
 		{"config", required_argument, NULL, 'c'},
 		{"validate", no_argument, NULL, 'C'},
+		{"profile", no_argument, NULL, 'P'},
 		{"debug", no_argument, NULL, 'd'},
 		{"version", no_argument, NULL, 'v'},
 		{"verbose", no_argument, NULL, 'V'},
@@ -274,6 +281,7 @@ int main(int argc, char **argv) {
 		"  -h, --help             Show help message and quit.\n"
 		"  -c, --config <config>  Specify a config file.\n"
 		"  -C, --validate         Check the validity of the config file, then exit.\n"
+		"      --profile          With --validate, print config parse times.\n"
 		"  -d, --debug            Enables full logging, including debug information.\n"
 		"  -v, --version          Show the version number and quit.\n"
 		"  -V, --verbose          Enables more verbose logging.\n"
@@ -306,6 +314,9 @@ int main(int argc, char **argv) {
 		case 'C': // validate
 			validate = 1;
 			break;
+		case 'P': // --profile
+			profile = 1;
+			break;
 		case 'd': // debug
 			debug = 1;
 			break;
@@ -334,6 +345,11 @@ int main(int argc, char **argv) {
 		}
 	}
 
+	if (profile && !validate) {
+		fprintf(stderr, "--profile requires --validate\n");
+		exit(EXIT_FAILURE);
+	}
+
 	// TODO: switch logging over to wlroots?
 	if (debug) {
 		wlr_log_init(WLR_DEBUG, NULL);
@@ -401,14 +417,18 @@ int main(int argc, char **argv) {
 
 	ipc_init(&server);
 	log_env();
+	latency_init();
 
 	if (validate) {
-		bool valid = load_main_config(config_path, false, true);
+		bool valid = load_main_config(config_path, false, true, profile);
+		if (profile) {
+			print_config_profile(config);
+		}
 		return valid ? 0 : 1;
 	}
 
 	setenv("WAYLAND_DISPLAY", server.socket, true);
-	if (!load_main_config(config_path, false, false)) {
+	if (!load_main_config(config_path, false, false, false)) {
 		sway_terminate(EXIT_FAILURE);
 	}
 
@@ -447,6 +467,7 @@ int main(int argc, char **argv) {
 
 	wlr_log(WLR_INFO, "Shutting down sway");
 
+	latency_finish();
 	server_fini(&server);
 	root_destroy();
 
@@ -13,7 +13,9 @@
 #include <wlr/types/wlr_idle.h>
 #include <wlr/types/wlr_layer_shell.h>
 #include <wlr/types/wlr_linux_dmabuf_v1.h>
+#include <wlr/types/wlr_pointer_constraints_v1.h>
 #include <wlr/types/wlr_primary_selection.h>
+#include <wlr/types/wlr_relative_pointer_v1.h>
 #include <wlr/types/wlr_screencopy_v1.h>
 #include <wlr/types/wlr_server_decoration.h>
 #include <wlr/types/wlr_xcursor_manager.h>
@@ -117,6 +119,15 @@ bool server_init(struct sway_server *server) {
 	server->server_decoration.notify = handle_server_decoration;
 	wl_list_init(&server->decorations);
 
+	server->relative_pointer_manager =
+		wlr_relative_pointer_manager_v1_create(server->wl_display);
+
+	server->pointer_constraints =
+		wlr_pointer_constraints_v1_create(server->wl_display);
+	wl_signal_add(&server->pointer_constraints->events.new_constraint,
+		&server->pointer_constraint);
+	server->pointer_constraint.notify = handle_pointer_constraint;
+
 	wlr_linux_dmabuf_v1_create(server->wl_display, renderer);
 	wlr_export_dmabuf_manager_v1_create(server->wl_display);
 	wlr_screencopy_manager_v1_create(server->wl_display);
@@ -98,6 +98,7 @@ struct sway_container *container_create(enum sway_container_type type) {
 	c->gaps_outer = 0;
 	c->current_gaps = 0;
 
+	root_add_container_id(c);
 	return c;
 }
 
@@ -114,6 +115,7 @@ void container_destroy(struct sway_container *con) {
 				"which is still referenced by transactions")) {
 		return;
 	}
+	root_remove_container_id(con);
 	free(con->name);
 	free(con->formatted_title);
 	wlr_texture_destroy(con->title_focused);
@@ -966,6 +968,7 @@ void container_floating_move_to_center(struct sway_container *con) {
 }
 
 void container_set_dirty(struct sway_container *container) {
+	root_container.sway_root->generation++;
 	if (container->dirty) {
 		return;
 	}
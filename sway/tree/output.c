@@ -164,6 +164,7 @@ void output_destroy(struct sway_container *output) {
 				"which is still referenced by transactions")) {
 		return;
 	}
+	root_remove_container_id(output);
 	free(output->name);
 	free(output->formatted_title);
 	wlr_texture_destroy(output->title_focused);
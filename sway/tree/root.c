@@ -41,6 +41,8 @@ void root_create(void) {
 	wl_signal_init(&root_container.sway_root->events.new_container);
 	root_container.sway_root->scratchpad = create_list();
 	root_container.sway_root->saved_workspaces = create_list();
+	root_container.sway_root->containers_by_id = create_hash_table();
+	root_container.sway_root->views_by_mark = create_hash_table();
 
 	root_container.sway_root->output_layout_change.notify =
 		output_layout_handle_change;
@@ -53,6 +55,8 @@ void root_destroy(void) {
 	wl_list_remove(&root_container.sway_root->output_layout_change.link);
 	list_free(root_container.sway_root->scratchpad);
 	list_free(root_container.sway_root->saved_workspaces);
+	hash_table_free(root_container.sway_root->containers_by_id);
+	hash_table_free(root_container.sway_root->views_by_mark);
 	wlr_output_layout_destroy(root_container.sway_root->output_layout);
 	free(root_container.sway_root);
 
@@ -337,3 +341,28 @@ struct sway_container *root_find_container(
 	}
 	return NULL;
 }
+
+void root_add_container_id(struct sway_container *con) {
+	if (!root_container.sway_root) {
+		return;
+	}
+	hash_table_set(root_container.sway_root->containers_by_id,
+			&con->id, sizeof(con->id), con);
+}
+
+void root_remove_container_id(struct sway_container *con) {
+	if (!root_container.sway_root) {
+		return;
+	}
+	hash_table_remove(root_container.sway_root->containers_by_id,
+			&con->id, sizeof(con->id));
+}
+
+struct sway_container *root_find_container_by_id(size_t id) {
+	struct sway_container *con = hash_table_get(
+			root_container.sway_root->containers_by_id, &id, sizeof(id));
+	if (!con || con->destroying) {
+		return NULL;
+	}
+	return con;
+}
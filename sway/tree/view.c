@@ -1,5 +1,6 @@
 #define _POSIX_C_SOURCE 200809L
 #include <stdlib.h>
+#include <string.h>
 #include <strings.h>
 #include <wayland-server.h>
 #include <wlr/render/wlr_renderer.h>
@@ -19,6 +20,7 @@
 #include "sway/input/seat.h"
 #include "sway/tree/arrange.h"
 #include "sway/tree/container.h"
+#include "sway/tree/root.h"
 #include "sway/tree/view.h"
 #include "sway/tree/workspace.h"
 #include "sway/config.h"
@@ -32,9 +34,18 @@ void view_init(struct sway_view *view, enum sway_view_type type,
 	view->executed_criteria = create_list();
 	view->marks = create_list();
 	view->allow_request_urgent = true;
+	wl_list_init(&view->saved_buffers);
 	wl_signal_init(&view->events.unmap);
 }
 
+static void remove_mark_index(struct sway_view *view, const char *mark) {
+	hash_table_t *index = root_container.sway_root->views_by_mark;
+	// Another view may have been given the mark after this one was unmapped
+	if (hash_table_get(index, mark, strlen(mark)) == view) {
+		hash_table_remove(index, mark, strlen(mark));
+	}
+}
+
 void view_destroy(struct sway_view *view) {
 	if (!sway_assert(view->surface == NULL, "Tried to free mapped view")) {
 		return;
@@ -48,8 +59,14 @@ void view_destroy(struct sway_view *view) {
 				"(might have a pending transaction?)")) {
 		return;
 	}
+	if (view_has_saved_buffer(view)) {
+		view_remove_saved_buffer(view);
+	}
 	list_free(view->executed_criteria);
 
+	for (int i = 0; i < view->marks->length; ++i) {
+		remove_mark_index(view, view->marks->items[i]);
+	}
 	list_foreach(view->marks, free);
 	list_free(view->marks);
 
@@ -372,13 +389,13 @@ static bool view_has_executed_criteria(struct sway_view *view,
 	return false;
 }
 
-void view_execute_criteria(struct sway_view *view) {
+void view_execute_criteria(struct sway_view *view, uint32_t changed) {
 	if (!view->swayc) {
 		return;
 	}
 	struct sway_seat *seat = input_manager_current_seat(input_manager);
 	struct sway_container *prior_focus = seat_get_focus(seat);
-	list_t *criterias = criteria_for_view(view, CT_COMMAND);
+	list_t *criterias = criteria_for_view_changed(view, CT_COMMAND, changed);
 	for (int i = 0; i < criterias->length; i++) {
 		struct criteria *criteria = criterias->items[i];
 		wlr_log(WLR_DEBUG, "Checking criteria %s", criteria->raw);
@@ -390,7 +407,13 @@ void view_execute_criteria(struct sway_view *view) {
 				criteria->raw, view, criteria->cmdlist);
 		seat_set_focus(seat, view->swayc);
 		list_add(view->executed_criteria, criteria);
-		struct cmd_results *res = execute_command(criteria->cmdlist, NULL);
+		if (!criteria->compiled_cmdlist && !criteria->uncompilable) {
+			criteria->compiled_cmdlist = compile_command(criteria->cmdlist);
+			criteria->uncompilable = !criteria->compiled_cmdlist;
+		}
+		struct cmd_results *res = criteria->compiled_cmdlist ?
+			execute_compiled_command(criteria->compiled_cmdlist, NULL) :
+			execute_command(criteria->cmdlist, NULL);
 		if (res->status != CMD_SUCCESS) {
 			wlr_log(WLR_ERROR, "Command '%s' failed: %s", res->input, res->error);
 		}
@@ -538,7 +561,7 @@ void view_map(struct sway_view *view, struct wlr_surface *wlr_surface) {
 
 	view_update_title(view, false);
 	container_notify_subtree_changed(view->swayc->parent);
-	view_execute_criteria(view);
+	view_execute_criteria(view, VIEW_MASK_ALL);
 }
 
 void view_unmap(struct sway_view *view) {
@@ -828,36 +851,29 @@ void view_update_title(struct sway_view *view, bool force) {
 	ipc_event_window(view->swayc, "title");
 }
 
-static bool find_by_mark_iterator(struct sway_container *con,
-		void *data) {
-	char *mark = data;
-	return con->type == C_VIEW && view_has_mark(con->sway_view, mark);
-}
-
 struct sway_view *view_find_mark(char *mark) {
-	struct sway_container *container = root_find_container(
-			find_by_mark_iterator, mark);
-	if (!container) {
+	struct sway_view *view = hash_table_get(
+			root_container.sway_root->views_by_mark, mark, strlen(mark));
+	if (!view || !view->swayc || view->swayc->destroying) {
 		return NULL;
 	}
-	return container->sway_view;
+	return view;
 }
 
 bool view_find_and_unmark(char *mark) {
-	struct sway_container *container = root_find_container(
-		find_by_mark_iterator, mark);
-	if (!container) {
+	struct sway_view *view = view_find_mark(mark);
+	if (!view) {
 		return false;
 	}
-	struct sway_view *view = container->sway_view;
 
 	for (int i = 0; i < view->marks->length; ++i) {
 		char *view_mark = view->marks->items[i];
 		if (strcmp(view_mark, mark) == 0) {
+			remove_mark_index(view, view_mark);
 			free(view_mark);
 			list_del(view->marks, i);
 			view_update_marks_textures(view);
-			ipc_event_window(container, "mark");
+			ipc_event_window(view->swayc, "mark");
 			return true;
 		}
 	}
@@ -866,6 +882,9 @@ bool view_find_and_unmark(char *mark) {
 
 void view_clear_marks(struct sway_view *view) {
 	while (view->marks->length) {
+		char *mark = view->marks->items[0];
+		remove_mark_index(view, mark);
+		free(mark);
 		list_del(view->marks, 0);
 		ipc_event_window(view->swayc, "mark");
 	}
@@ -883,6 +902,8 @@ bool view_has_mark(struct sway_view *view, char *mark) {
 
 void view_add_mark(struct sway_view *view, char *mark) {
 	list_add(view->marks, strdup(mark));
+	hash_table_set(root_container.sway_root->views_by_mark,
+			mark, strlen(mark), view);
 	ipc_event_window(view->swayc, "mark");
 }
 
@@ -1047,21 +1068,52 @@ bool view_is_urgent(struct sway_view *view) {
 	return view->urgent.tv_sec || view->urgent.tv_nsec;
 }
 
+bool view_has_saved_buffer(struct sway_view *view) {
+	return !wl_list_empty(&view->saved_buffers);
+}
+
 void view_remove_saved_buffer(struct sway_view *view) {
-	if (!sway_assert(view->saved_buffer, "Expected a saved buffer")) {
+	if (!sway_assert(view_has_saved_buffer(view), "Expected a saved buffer")) {
+		return;
+	}
+	struct sway_saved_buffer *saved_buf, *tmp;
+	wl_list_for_each_safe(saved_buf, tmp, &view->saved_buffers, link) {
+		wlr_buffer_unref(saved_buf->buffer);
+		wl_list_remove(&saved_buf->link);
+		free(saved_buf);
+	}
+}
+
+static void view_save_buffer_iterator(struct wlr_surface *surface,
+		int sx, int sy, void *data) {
+	struct sway_view *view = data;
+	if (!wlr_surface_has_buffer(surface)) {
+		return;
+	}
+	struct sway_saved_buffer *saved_buf =
+		calloc(1, sizeof(struct sway_saved_buffer));
+	if (!saved_buf) {
+		wlr_log(WLR_ERROR, "Unable to allocate saved buffer");
 		return;
 	}
-	wlr_buffer_unref(view->saved_buffer);
-	view->saved_buffer = NULL;
+	saved_buf->buffer = wlr_buffer_ref(surface->buffer);
+	saved_buf->x = sx;
+	saved_buf->y = sy;
+	saved_buf->width = surface->current.width;
+	saved_buf->height = surface->current.height;
+	saved_buf->transform = surface->current.transform;
+	wl_list_insert(view->saved_buffers.prev, &saved_buf->link);
 }
 
 void view_save_buffer(struct sway_view *view) {
-	if (!sway_assert(!view->saved_buffer, "Didn't expect saved buffer")) {
+	if (!sway_assert(!view_has_saved_buffer(view),
+				"Didn't expect saved buffer")) {
 		view_remove_saved_buffer(view);
 	}
-	if (view->surface && wlr_surface_has_buffer(view->surface)) {
-		view->saved_buffer = wlr_buffer_ref(view->surface->buffer);
-		view->saved_buffer_width = view->surface->current.width;
-		view->saved_buffer_height = view->surface->current.height;
+	if (view->surface) {
+		// Subsurfaces are iterated from bottom to top, which is the order
+		// they're rendered in
+		wlr_surface_for_each_surface(view->surface,
+				view_save_buffer_iterator, view);
 	}
 }
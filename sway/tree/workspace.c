@@ -91,6 +91,8 @@ void workspace_destroy(struct sway_container *workspace) {
 				"which is still referenced by transactions")) {
 		return;
 	}
+	root_remove_container_id(workspace);
+
 	// sway_workspace
 	struct sway_workspace *ws = workspace->sway_workspace;
 	list_foreach(ws->output_priority, free);
@@ -466,6 +468,10 @@ bool workspace_switch(struct sway_container *workspace,
 				--i;
 			}
 		}
+		if (has_sticky) {
+			// Its current floating list still has the moved floaters
+			container_set_dirty(next_output_prev_ws);
+		}
 	}
 
 	wlr_log(WLR_DEBUG, "Switching to workspace %p:%s",
@@ -483,8 +489,12 @@ bool workspace_switch(struct sway_container *workspace,
 		workspace_consider_destroy(active_ws);
 	}
 	seat_set_focus(seat, next);
+	// Only the workspace being switched to needs arranging. The output is
+	// marked dirty so its active workspace is updated in the transaction, but
+	// arranging it would pull every hidden workspace into the transaction.
 	struct sway_container *output = container_parent(workspace, C_OUTPUT);
-	arrange_windows(output);
+	container_set_dirty(output);
+	arrange_windows(workspace);
 	return true;
 }
 